@@ -17,17 +17,34 @@
 
 #include "piece.h"
 #include <stdint.h>
+#include <stdbool.h>
 
-#define UP 0
-#define UP_RIGHT 1
-#define RIGHT 2
-#define DOWN_RIGHT 3
-#define DOWN 4
-#define DOWN_LEFT 5
-#define LEFT 6
-#define UP_LEFT 7
+// PEXT is selected at runtime, so the binary still runs on hosts without BMI2.
+#if defined(__x86_64__) && !defined(NO_PEXT)
+#define ATTACK_TABLE_PEXT
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+#endif
 
-typedef struct attack_table {
+// Sum of 2^(relevant occupancy bits) over all squares.
+#define ROOK_ATTACKS_SIZE 102400
+#define BISHOP_ATTACKS_SIZE 5248
+
+/*
+ * Magic bitboard entry for one square. The relevant occupancy is multiplied by
+ * the magic number and shifted down to an index into the shared attack array,
+ * starting at offset. With PEXT the index is the extracted occupancy bits instead.
+ */
+typedef struct {
+    uint64_t mask;
+    uint64_t magic;
+    int shift;
+    int offset;
+} Magic;
+
+// Tables that don't depend on how the slider attacks are indexed, shared by every variant.
+typedef struct {
     uint64_t king_table[64];
     uint64_t queen_table[64];
     uint64_t rook_table[64];
@@ -38,16 +55,70 @@ typedef struct attack_table {
     uint64_t white_pawn_attack_table[64];
     uint64_t black_pawn_attack_table[64];
 
-    uint64_t ray_dir_table[64][8];
+    // Squares strictly between two aligned squares, and the full line through them. Empty if not aligned.
+    uint64_t between[64][64];
+    uint64_t line[64][64];
+} AttackTableCommon;
+
+typedef struct attack_table {
+    const AttackTableCommon* common;
+
+    Magic rook_magics[64];
+    Magic bishop_magics[64];
+    uint64_t rook_attacks[ROOK_ATTACKS_SIZE];
+    uint64_t bishop_attacks[BISHOP_ATTACKS_SIZE];
+
+    // True if the attack arrays are indexed with PEXT instead of magics.
+    bool use_pext;
 } AttackTable;
 
-AttackTable* attack_table_create();
+// The tables are static read-only data, so there is nothing to free.
+const AttackTable* attack_table_create();
 
 // Gets the attacks. For pawns, this means just the diagonal moves.
-uint64_t attack_table_get_board(int index, PieceType piece_type, AttackTable* attack_table);
+uint64_t attack_table_get_board(int index, PieceType piece_type, const AttackTable* attack_table);
 
-void attack_table_print(uint64_t bit_board);
+#ifdef ATTACK_TABLE_PEXT
+static inline uint64_t attack_table_pext(uint64_t source, uint64_t mask) {
+#ifdef __BMI2__
+    return _pext_u64(source, mask);
+#else
+    // Without -mbmi2 the intrinsic can't be inlined, so emit the instruction directly.
+    uint64_t result;
+    __asm__("pextq %2, %1, %0" : "=r"(result) : "r"(source), "r"(mask));
+    return result;
+#endif
+}
+#endif
+
+// Sliding attacks for the given occupancy. The first blocker in each direction is included.
+static inline uint64_t attack_table_get_rook_attacks(int index, uint64_t occupancy, const AttackTable* attack_table) {
+    const Magic* magic = &attack_table->rook_magics[index];
+#ifdef ATTACK_TABLE_PEXT
+    if (attack_table->use_pext) {
+        return attack_table->rook_attacks[magic->offset + attack_table_pext(occupancy, magic->mask)];
+    }
+#endif
+    uint64_t key = ((occupancy & magic->mask) * magic->magic) >> magic->shift;
+    return attack_table->rook_attacks[magic->offset + key];
+}
 
-void attack_table_destroy(AttackTable* attack_table);
+static inline uint64_t attack_table_get_bishop_attacks(int index, uint64_t occupancy, const AttackTable* attack_table) {
+    const Magic* magic = &attack_table->bishop_magics[index];
+#ifdef ATTACK_TABLE_PEXT
+    if (attack_table->use_pext) {
+        return attack_table->bishop_attacks[magic->offset + attack_table_pext(occupancy, magic->mask)];
+    }
+#endif
+    uint64_t key = ((occupancy & magic->mask) * magic->magic) >> magic->shift;
+    return attack_table->bishop_attacks[magic->offset + key];
+}
+
+static inline uint64_t attack_table_get_queen_attacks(int index, uint64_t occupancy, const AttackTable* attack_table) {
+    return attack_table_get_rook_attacks(index, occupancy, attack_table) |
+           attack_table_get_bishop_attacks(index, occupancy, attack_table);
+}
+
+void attack_table_print(uint64_t bit_board);
 
 #endif
@@ -0,0 +1,569 @@
+/*
+ * Build-time generator for the attack tables. Prints a C file defining the static const tables
+ * common to every variant once, and one AttackTable indexed with magics and one indexed with
+ * PEXT that both point at them. attacktable.c includes it, so the tables are read-only data that
+ * every process loading the engine shares.
+ *
+ * Usage: attacktablegen > attacktable_data.inc
+ *        attacktablegen --find-magics    Searches the magic numbers again and prints them as C
+ *                                        arrays, to replace ROOK_MAGICS and BISHOP_MAGICS below.
+ */
+
+#include "attacktable.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+uint64_t set_bit(uint64_t bit_board, int x, int y);
+uint64_t get_knight_board(int x, int y);
+uint64_t get_king_board(int x, int y);
+uint64_t get_rook_board(int x, int y);
+uint64_t get_bishop_board(int x, int y);
+uint64_t get_queen_board(int x, int y);
+uint64_t get_white_pawn_board(int x, int y);
+uint64_t get_black_pawn_board(int x, int y);
+uint64_t get_white_pawn_attack_board(int x, int y);
+uint64_t get_black_pawn_attack_board(int x, int y);
+
+static void set_between_and_line_tables(AttackTableCommon* common);
+
+static void attack_table_common_build(AttackTableCommon* common);
+static void attack_table_build(AttackTable* attack_table, bool use_pext);
+static void print_attack_table_common(AttackTableCommon* common, const char* name);
+static void print_attack_table(AttackTable* attack_table, const char* name, const char* common_name);
+static void print_array(const char* name, const uint64_t* array, int size, const char* indent);
+static void print_array_2d(const char* name, const uint64_t* array, int columns);
+static void print_magics(const char* name, const Magic* magics);
+static void set_magic_tables(AttackTable* attack_table, bool diagonal);
+static uint64_t get_relevant_occupancy_mask(int index, bool diagonal);
+static uint64_t get_slider_attacks_slow(int index, uint64_t occupancy, bool diagonal);
+static void print_found_magics(const char* name, bool diagonal);
+static uint64_t find_magic(uint64_t mask, int bit_count, uint64_t* occupancies, uint64_t* attacks);
+static uint64_t random_sparse_uint64();
+
+static const int ROOK_DIRECTIONS[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+static const int BISHOP_DIRECTIONS[4][2] = {{1, 1}, {1, -1}, {-1, -1}, {-1, 1}};
+
+/*
+ * Magics found once with a random sparse search. Each one maps every occupancy
+ * subset of the square's mask into 2^(relevant bits) slots without destructive
+ * collisions. Searching at startup took around half a second. The search is
+ * deterministic, attacktablegen --find-magics reproduces these tables.
+ */
+static const uint64_t ROOK_MAGICS[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+};
+
+static const uint64_t BISHOP_MAGICS[64] = {
+    0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+    0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+    0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+    0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+    0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL,
+};
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--find-magics") == 0) {
+        // Rooks first, the random sequence continues into the bishop search.
+        print_found_magics("ROOK_MAGICS", false);
+        print_found_magics("BISHOP_MAGICS", true);
+        return 0;
+    }
+
+    AttackTableCommon* common = malloc(sizeof(AttackTableCommon));
+    AttackTable* attack_table = malloc(sizeof(AttackTable));
+
+    printf("// Generated by attacktablegen.c, do not edit.\n\n");
+
+    attack_table_common_build(common);
+    print_attack_table_common(common, "ATTACK_TABLE_COMMON_DATA");
+
+    attack_table_build(attack_table, false);
+    print_attack_table(attack_table, "ATTACK_TABLE_MAGIC_DATA", "ATTACK_TABLE_COMMON_DATA");
+
+    // The PEXT indexed attacks are only usable where the lookup functions can emit PEXT.
+    printf("#ifdef ATTACK_TABLE_PEXT\n");
+    attack_table_build(attack_table, true);
+    print_attack_table(attack_table, "ATTACK_TABLE_PEXT_DATA", "ATTACK_TABLE_COMMON_DATA");
+    printf("#endif\n");
+
+    free(attack_table);
+    free(common);
+    return 0;
+}
+
+/* ------------------- Internal functions --------------------*/
+
+static void attack_table_common_build(AttackTableCommon* common) {
+    for (int i = 0 ; i < 64 ; i++) {
+        int x = i % 8;
+        int y = i / 8;
+
+        common->knight_table[i] = get_knight_board(x, y);
+        common->king_table[i] = get_king_board(x, y);
+        common->rook_table[i] = get_rook_board(x, y);
+        common->bishop_table[i] = get_bishop_board(x, y);
+        common->queen_table[i] = get_queen_board(x, y);
+        common->white_pawn_table[i] = get_white_pawn_board(x, y);
+        common->black_pawn_table[i] = get_black_pawn_board(x, y);
+        common->white_pawn_attack_table[i] = get_white_pawn_attack_board(x, y);
+        common->black_pawn_attack_table[i] = get_black_pawn_attack_board(x, y);
+    }
+
+    set_between_and_line_tables(common);
+}
+
+// Only the slider attacks differ between the variants.
+static void attack_table_build(AttackTable* attack_table, bool use_pext) {
+    attack_table->use_pext = use_pext;
+    set_magic_tables(attack_table, false);
+    set_magic_tables(attack_table, true);
+}
+
+static void print_attack_table_common(AttackTableCommon* common, const char* name) {
+    printf("static const AttackTableCommon %s = {\n", name);
+
+    print_array(".king_table", common->king_table, 64, "    ");
+    print_array(".queen_table", common->queen_table, 64, "    ");
+    print_array(".rook_table", common->rook_table, 64, "    ");
+    print_array(".bishop_table", common->bishop_table, 64, "    ");
+    print_array(".knight_table", common->knight_table, 64, "    ");
+    print_array(".white_pawn_table", common->white_pawn_table, 64, "    ");
+    print_array(".black_pawn_table", common->black_pawn_table, 64, "    ");
+    print_array(".white_pawn_attack_table", common->white_pawn_attack_table, 64, "    ");
+    print_array(".black_pawn_attack_table", common->black_pawn_attack_table, 64, "    ");
+
+    print_array_2d(".between", &common->between[0][0], 64);
+    print_array_2d(".line", &common->line[0][0], 64);
+    printf("};\n\n");
+}
+
+static void print_attack_table(AttackTable* attack_table, const char* name, const char* common_name) {
+    printf("static const AttackTable %s = {\n", name);
+    printf("    .common = &%s,\n", common_name);
+
+    print_magics(".rook_magics", attack_table->rook_magics);
+    print_magics(".bishop_magics", attack_table->bishop_magics);
+    print_array(".rook_attacks", attack_table->rook_attacks, ROOK_ATTACKS_SIZE, "    ");
+    print_array(".bishop_attacks", attack_table->bishop_attacks, BISHOP_ATTACKS_SIZE, "    ");
+
+    printf("    .use_pext = %s,\n", attack_table->use_pext ? "true" : "false");
+    printf("};\n\n");
+}
+
+// Prints a designated initializer, or a plain one if the name is empty.
+static void print_array(const char* name, const uint64_t* array, int size, const char* indent) {
+    printf("%s%s%s{", indent, name, *name ? " = " : "");
+    for (int i = 0 ; i < size ; i++) {
+        if (i % 4 == 0) {
+            printf("\n%s    ", indent);
+        }
+        else {
+            printf(" ");
+        }
+        printf("0x%016llXULL,", (unsigned long long)array[i]);
+    }
+    printf("\n%s},\n", indent);
+}
+
+// A [64][columns] array, one inner initializer per square.
+static void print_array_2d(const char* name, const uint64_t* array, int columns) {
+    printf("    %s = {\n", name);
+    for (int i = 0 ; i < 64 ; i++) {
+        print_array("", &array[i * columns], columns, "        ");
+    }
+    printf("    },\n");
+}
+
+static void print_magics(const char* name, const Magic* magics) {
+    printf("    %s = {\n", name);
+    for (int i = 0 ; i < 64 ; i++) {
+        printf("        {0x%016llXULL, 0x%016llXULL, %d, %d},\n", 
+               (unsigned long long)magics[i].mask, (unsigned long long)magics[i].magic, magics[i].shift, magics[i].offset);
+    }
+    printf("    },\n");
+}
+
+/**
+ * @brief   If the given coordinate is in range, sets the bit at the coordinate
+ *          to 1.
+ * 
+ * @param bit_board The bit-board.
+ * @param x         The x-coordinate.
+ * @param y         The y-coordinate. 
+ */
+uint64_t set_bit(uint64_t bit_board, int x, int y) {
+    if ((x < 0) || (x > 7) || (y < 0) || (y > 7)) {
+        return bit_board;
+    }
+    int shifts = y * 8 + x;
+
+    return bit_board | 1ULL << shifts;
+}
+
+uint64_t get_knight_board(int x, int y) {
+    uint64_t knight_board = 0;
+    
+    // Up
+    knight_board = set_bit(knight_board, x - 1, y - 2);
+    knight_board = set_bit(knight_board, x + 1, y - 2);
+
+    // Right
+    knight_board = set_bit(knight_board, x + 2, y - 1);
+    knight_board = set_bit(knight_board, x + 2, y + 1);
+
+    // Left
+    knight_board = set_bit(knight_board, x - 2, y - 1);
+    knight_board = set_bit(knight_board, x - 2, y + 1);
+
+    // Down
+    knight_board = set_bit(knight_board, x - 1, y + 2);
+    knight_board = set_bit(knight_board, x + 1, y + 2);
+
+    return knight_board;
+}
+
+uint64_t get_king_board(int x, int y) {
+    uint64_t king_board = 0;
+
+    king_board = set_bit(king_board, x - 1, y - 1);
+    king_board = set_bit(king_board, x - 1, y);
+    king_board = set_bit(king_board, x - 1, y + 1);
+
+    king_board = set_bit(king_board, x, y - 1);
+    king_board = set_bit(king_board, x, y + 1);
+
+    king_board = set_bit(king_board, x + 1, y - 1);
+    king_board = set_bit(king_board, x + 1, y);
+    king_board = set_bit(king_board, x + 1, y + 1);
+
+    return king_board;
+}
+
+uint64_t get_rook_board(int x, int y) {
+    uint64_t rook_board = 0;
+
+    // Up
+    for (int i = y - 1 ; i >= 0 ; i--) {
+        rook_board = set_bit(rook_board, x, i);
+    }
+
+    // Right
+    for (int i = x + 1 ; i < 8 ; i++) {
+        rook_board = set_bit(rook_board, i, y);
+    }
+
+    // Down
+    for (int i = y + 1 ; i < 8 ; i++) {
+        rook_board = set_bit(rook_board, x, i);
+    }
+
+    // Left
+    for (int i = x - 1 ; i >= 0 ; i--) {
+        rook_board = set_bit(rook_board, i, y);
+    }
+
+    return rook_board;
+}
+
+uint64_t get_bishop_board(int x, int y) {
+    uint64_t bishop_board = 0;
+
+    // Up Right
+    int temp_x = x + 1;
+    int temp_y = y - 1;
+    while ((temp_x < 8) && (temp_y >= 0)) {
+        bishop_board = set_bit(bishop_board, temp_x, temp_y);
+        temp_x++;
+        temp_y--;
+    }
+
+    // Up Left
+    temp_x = x - 1;
+    temp_y = y - 1;
+    while ((temp_x >= 0) && (temp_y >= 0)) {
+        bishop_board = set_bit(bishop_board, temp_x, temp_y);
+        temp_x--;
+        temp_y--;
+    }
+
+    // Down Right
+    temp_x = x + 1;
+    temp_y = y + 1;
+    while ((temp_x < 8) && (temp_y < 8)) {
+        bishop_board = set_bit(bishop_board, temp_x, temp_y);
+        temp_x++;
+        temp_y++;
+    }
+
+    // Down Left
+    temp_x = x - 1;
+    temp_y = y + 1;
+    while ((temp_x >= 0) && (temp_y < 8)) {
+        bishop_board = set_bit(bishop_board, temp_x, temp_y);
+        temp_x--;
+        temp_y++;
+    }
+
+    return bishop_board;
+}
+
+uint64_t get_queen_board(int x, int y) {
+    uint64_t rook_board = get_rook_board(x, y);
+    uint64_t bishop_board = get_bishop_board(x, y);
+
+    return rook_board | bishop_board;
+}
+
+uint64_t get_white_pawn_board(int x, int y) {
+    uint64_t white_pawn_board = 0;
+
+    white_pawn_board = set_bit(white_pawn_board, x, y + 1);
+
+    if (y == 1) {
+        white_pawn_board = set_bit(white_pawn_board, x, y + 2);
+    }
+
+    return white_pawn_board;
+}
+
+uint64_t get_black_pawn_board(int x, int y) {
+    uint64_t black_pawn_board = 0;
+
+    black_pawn_board = set_bit(black_pawn_board, x, y - 1);
+
+    if (y == 6) {
+        black_pawn_board = set_bit(black_pawn_board, x, y - 2);
+    }
+
+    return black_pawn_board;
+}
+
+uint64_t get_white_pawn_attack_board(int x, int y) {
+    uint64_t white_pawn_attack_board = 0;
+
+    white_pawn_attack_board = set_bit(white_pawn_attack_board, x + 1, y + 1);
+    white_pawn_attack_board = set_bit(white_pawn_attack_board, x - 1, y + 1);
+
+    return white_pawn_attack_board;
+}
+
+uint64_t get_black_pawn_attack_board(int x, int y) {
+    uint64_t black_pawn_attack_board = 0;
+
+    black_pawn_attack_board = set_bit(black_pawn_attack_board, x + 1, y - 1);
+    black_pawn_attack_board = set_bit(black_pawn_attack_board, x - 1, y - 1);
+
+    return black_pawn_attack_board;
+}
+
+
+/**
+ * @brief   Fills the magics and the shared sliding attack array for either rooks
+ *          or bishops. Every occupancy subset of each square's mask is stored at
+ *          the index produced by its magic, or at its PEXT index if the table
+ *          uses PEXT.
+ */
+static void set_magic_tables(AttackTable* attack_table, bool diagonal) {
+    Magic* magics = diagonal ? attack_table->bishop_magics : attack_table->rook_magics;
+    const uint64_t* magic_numbers = diagonal ? BISHOP_MAGICS : ROOK_MAGICS;
+    uint64_t* attack_array = diagonal ? attack_table->bishop_attacks : attack_table->rook_attacks;
+    uint64_t occupancies[4096];
+    uint64_t attacks[4096];
+    int offset = 0;
+
+    for (int i = 0 ; i < 64 ; i++) {
+        uint64_t mask = get_relevant_occupancy_mask(i, diagonal);
+        int bit_count = __builtin_popcountll(mask);
+        int size = 1 << bit_count;
+
+        // Carry-Rippler trick to enumerate all subsets of the mask.
+        uint64_t subset = 0ULL;
+        for (int j = 0 ; j < size ; j++) {
+            occupancies[j] = subset;
+            attacks[j] = get_slider_attacks_slow(i, subset, diagonal);
+            subset = (subset - mask) & mask;
+        }
+
+        magics[i].mask = mask;
+        magics[i].magic = magic_numbers[i];
+        magics[i].shift = 64 - bit_count;
+        magics[i].offset = offset;
+
+        for (int j = 0 ; j < size ; j++) {
+            // The Carry-Rippler order is the PEXT order, so j is the PEXT index.
+            uint64_t key = attack_table->use_pext ? j : (occupancies[j] * magics[i].magic) >> magics[i].shift;
+            attack_array[offset + key] = attacks[j];
+        }
+
+        offset += size;
+    }
+}
+
+/*
+ * Two squares are aligned if a slider on one attacks the other on an empty board. The line is
+ * what both attack along that direction, and the squares between are what both attack when
+ * each is blocked by the other.
+ */
+static void set_between_and_line_tables(AttackTableCommon* common) {
+    for (int from = 0 ; from < 64 ; from++) {
+        for (int to = 0 ; to < 64 ; to++) {
+            common->between[from][to] = 0ULL;
+            common->line[from][to] = 0ULL;
+
+            for (int diagonal = 0 ; diagonal < 2 ; diagonal++) {
+                if (from == to || !(get_slider_attacks_slow(from, 0ULL, diagonal) & (1ULL << to))) {
+                    continue;
+                }
+
+                common->line[from][to] = (get_slider_attacks_slow(from, 0ULL, diagonal) & 
+                                                get_slider_attacks_slow(to, 0ULL, diagonal)) |
+                                               (1ULL << from) | (1ULL << to);
+                common->between[from][to] = get_slider_attacks_slow(from, 1ULL << to, diagonal) & 
+                                                  get_slider_attacks_slow(to, 1ULL << from, diagonal);
+            }
+        }
+    }
+}
+
+/* The squares whose occupancy affects the attacks. Edges never block anything behind them. */
+static uint64_t get_relevant_occupancy_mask(int index, bool diagonal) {
+    const int (*directions)[2] = diagonal ? BISHOP_DIRECTIONS : ROOK_DIRECTIONS;
+    uint64_t mask = 0ULL;
+
+    for (int dir = 0 ; dir < 4 ; dir++) {
+        int x = index % 8 + directions[dir][0];
+        int y = index / 8 + directions[dir][1];
+
+        while (x + directions[dir][0] >= 0 && x + directions[dir][0] <= 7 &&
+               y + directions[dir][1] >= 0 && y + directions[dir][1] <= 7) {
+            mask = set_bit(mask, x, y);
+            x += directions[dir][0];
+            y += directions[dir][1];
+        }
+    }
+
+    return mask;
+}
+
+/* Ray walking reference used to fill the magic tables. */
+static uint64_t get_slider_attacks_slow(int index, uint64_t occupancy, bool diagonal) {
+    const int (*directions)[2] = diagonal ? BISHOP_DIRECTIONS : ROOK_DIRECTIONS;
+    uint64_t attacks = 0ULL;
+
+    for (int dir = 0 ; dir < 4 ; dir++) {
+        int x = index % 8 + directions[dir][0];
+        int y = index / 8 + directions[dir][1];
+
+        while (x >= 0 && x <= 7 && y >= 0 && y <= 7) {
+            attacks = set_bit(attacks, x, y);
+            if (occupancy & (1ULL << (y * 8 + x))) {
+                break;
+            }
+            x += directions[dir][0];
+            y += directions[dir][1];
+        }
+    }
+
+    return attacks;
+}
+
+static void print_found_magics(const char* name, bool diagonal) {
+    uint64_t occupancies[4096];
+    uint64_t attacks[4096];
+
+    printf("static const uint64_t %s[64] = {", name);
+    for (int i = 0 ; i < 64 ; i++) {
+        uint64_t mask = get_relevant_occupancy_mask(i, diagonal);
+        int bit_count = __builtin_popcountll(mask);
+        int size = 1 << bit_count;
+
+        uint64_t subset = 0ULL;
+        for (int j = 0 ; j < size ; j++) {
+            occupancies[j] = subset;
+            attacks[j] = get_slider_attacks_slow(i, subset, diagonal);
+            subset = (subset - mask) & mask;
+        }
+
+        printf(i % 4 == 0 ? "\n    " : " ");
+        printf("0x%016llXULL,", (unsigned long long)find_magic(mask, bit_count, occupancies, attacks));
+    }
+    printf("\n};\n\n");
+}
+
+/* Tries random sparse candidates until one maps every occupancy without destructive collisions. */
+static uint64_t find_magic(uint64_t mask, int bit_count, uint64_t* occupancies, uint64_t* attacks) {
+    static uint64_t used[4096];
+    static int used_epoch[4096];
+    static int epoch = 0;
+    int size = 1 << bit_count;
+
+    while (true) {
+        uint64_t magic = random_sparse_uint64();
+
+        // Quickly reject candidates that don't spread the high bits.
+        if (__builtin_popcountll((mask * magic) & 0xFF00000000000000ULL) < 6) {
+            continue;
+        }
+
+        epoch++;
+        bool failed = false;
+        for (int i = 0 ; i < size && !failed ; i++) {
+            int key = (occupancies[i] * magic) >> (64 - bit_count);
+
+            if (used_epoch[key] != epoch) {
+                used_epoch[key] = epoch;
+                used[key] = attacks[i];
+            }
+            else if (used[key] != attacks[i]) {
+                failed = true;
+            }
+        }
+
+        if (!failed) {
+            return magic;
+        }
+    }
+}
+
+/* XOR-shift with a fixed seed, so the magic search is deterministic. */
+static uint64_t random_sparse_uint64() {
+    static uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t numbers[3];
+
+    for (int i = 0 ; i < 3 ; i++) {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        numbers[i] = seed * 0x2545F4914F6CDD1DULL;
+    }
+
+    return numbers[0] & numbers[1] & numbers[2];
+}
@@ -2,6 +2,7 @@
 #include "movegenerator.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "fenparser.h"
 #include "evaluate.h"
 #include "search.h"
@@ -12,26 +13,40 @@
 #define BLACK_CASTLE_QUEEN (1 << 2) // 0100
 #define BLACK_CASTLE_KING  (1 << 3) // 1000
 
-#define UNDO_STACK_START_CAPACITY 30
-
 
 /* -------------------- Internal function declarations --------------------- */
 void update_castling_rights(Move move, PieceType piece_type, Board* board);
 void print_piece(PieceType piece_type);
-void make_castle_move(Move move, Board* board);
-void make_en_passant_move(Move move, PieceType piece_type,  Board* board);
-void unmake_castle_move(Move move, Board* board);
-void undo_stack_push(Move move, Board* board);
-UndoNode undo_stack_pop(Board* board);
+static inline void undo_stack_push(FullMove move, Board* board);
+static inline UndoNode undo_stack_pop(Board* board);
 
 uint64_t rand_uint64(uint64_t seed);
 uint64_t calculate_zobrist_hash(Board* board);
 int piece_to_zobrist_index(PieceType type);
+static inline void material_key_update(PieceType type, int count, Board* board);
 
 static uint64_t zobrist_table[64][12];
 static uint16_t zobrist_castling[16];
 static uint64_t zobrist_en_passant_file[8];
 static uint64_t zobrist_side_to_move;
+// Keyed by piece and how many of it there are, see material_key_update.
+static uint64_t zobrist_material[12][64];
+
+static inline int castle_rook_from(int king_to_index);
+static inline int castle_rook_to(int king_to_index);
+
+/* Make and unmake for each side, see board_side.h. */
+#define SIDE_IS_WHITE 1
+#define SIDE_FN(name) name##_white
+#include "board_side.h"
+#undef SIDE_IS_WHITE
+#undef SIDE_FN
+
+#define SIDE_IS_WHITE 0
+#define SIDE_FN(name) name##_black
+#include "board_side.h"
+#undef SIDE_IS_WHITE
+#undef SIDE_FN
 
 
 /* ---------------------Internal Zobrist hashing functions ------------------*/
@@ -67,12 +82,58 @@ void zobrist_init() {
 
     rand_seed = rand_uint64(rand_seed);
     zobrist_side_to_move = rand_seed;
+
+    for (int i = 0 ; i < 12 ; i++) {
+        for (int j = 0 ; j < 64 ; j++) {
+            rand_seed = rand_uint64(rand_seed);
+            zobrist_material[i][j] = rand_seed;
+        }
+    }
 }
 
 uint64_t board_get_zobrist_hash(Board* board) {
     return board->current_zobrist_hash;
 }
 
+uint64_t board_get_pawn_hash(Board* board) {
+    return board->pawn_zobrist_hash;
+}
+
+uint64_t board_get_material_key(Board* board) {
+    return board->material_key;
+}
+
+uint64_t calculate_pawn_hash(Board* board) {
+    uint64_t pawn_hash = 0ULL;
+    uint64_t pawns = board->bit_boards[WHITE_PAWN] | board->bit_boards[BLACK_PAWN];
+
+    while (pawns) {
+        int current_index = __builtin_ctzll(pawns);
+        pawns &= pawns - 1;
+
+        pawn_hash ^= zobrist_table[current_index][piece_to_zobrist_index(board_get_piece(current_index, board))];
+    }
+
+    return pawn_hash;
+}
+
+uint64_t calculate_material_key(Board* board) {
+    uint64_t material_key = 0ULL;
+
+    for (PieceType type = WHITE_KING ; type <= BLACK_PAWN ; type++) {
+        if (type == WHITE_PIECES) {
+            continue;
+        }
+
+        int count = __builtin_popcountll(board->bit_boards[type]);
+        for (int i = 0 ; i < count ; i++) {
+            material_key ^= zobrist_material[piece_to_zobrist_index(type)][i];
+        }
+    }
+
+    return material_key;
+}
+
 uint64_t calculate_zobrist_hash(Board* board) {
     uint64_t zobrist_hash = 0ULL;
     uint64_t all_pieces = board->bit_boards[WHITE_PIECES] | board->bit_boards[BLACK_PIECES];
@@ -100,6 +161,14 @@ uint64_t calculate_zobrist_hash(Board* board) {
     return zobrist_hash;
 }
 
+/*
+ * The material key XORs in one number for each piece of a type up to its count, so adding a
+ * piece to count pieces or removing one down to count pieces both XOR the number for count.
+ */
+static inline void material_key_update(PieceType type, int count, Board* board) {
+    board->material_key ^= zobrist_material[piece_to_zobrist_index(type)][count];
+}
+
 int piece_to_zobrist_index(PieceType type) {
     switch (type) {
         case WHITE_KING:   return 0;
@@ -127,20 +196,37 @@ Board* board_create() {
     for (int i = 0 ; i < BIT_BOARD_COUNT ; i++) {
         board->bit_boards[i] = 0ULL;
     }
+    for (int i = 0 ; i < 64 ; i++) {
+        board->pieces[i] = -1;
+    }
     board->turn = true;
     board->en_passant_index = -1;
     board->castling_rights = 0x0F;
-    board->undo_stack = calloc(UNDO_STACK_START_CAPACITY, sizeof(UndoNode));
-    board->undo_stack_capacity = UNDO_STACK_START_CAPACITY;
     board->undo_stack_size = 0;
     board->current_zobrist_hash = calculate_zobrist_hash(board);
+    board->pawn_zobrist_hash = 0ULL;
+    board->material_key = 0ULL;
+    board->material[0] = board->material[1] = 0;
+    board->piece_square[0] = board->piece_square[1] = 0;
 
     return board;
 }
 
 Board* board_from_fen(char* fen, int size) {
     Board* new_board = fen_to_board(fen, size);
+    if (!new_board) {
+        return NULL;
+    }
     new_board->current_zobrist_hash = calculate_zobrist_hash(new_board);
+    new_board->pawn_zobrist_hash = calculate_pawn_hash(new_board);
+    new_board->material_key = calculate_material_key(new_board);
+    return new_board;
+}
+
+Board* board_copy(Board* board) {
+    Board* new_board = malloc(sizeof(Board));
+    *new_board = *board;
+
     return new_board;
 }
 
@@ -152,8 +238,8 @@ int board_evaluate_current(Board* board) {
     return evaluate_board(board);
 }
 
-Move board_get_best_move(Board* board, AttackTable* attack_table, int depth, SearchAlg alg) {
-    return search_best_move(board, attack_table, depth, alg);
+Move board_get_best_move(Board* board, const AttackTable* attack_table, int depth, SearchAlg alg) {
+    return search_best_move(board, attack_table, NULL, depth, alg);
 }
 
 bool board_get_turn(Board* board) {
@@ -180,126 +266,137 @@ void board_draw(Board* board) {
     printf("   a b c d e f g h \n");
 }
 
-void board_push_move(Move move, Board* board) {
-    if (!move_exists(move)) {
-        return;
+bool board_push_move(Move move, Board* board) {
+    if (!move_exists(move) || board->undo_stack_size >= MAX_GAME_PLIES) {
+        return false;
     }
-    
-    undo_stack_push(move, board);
-    int from_index = move_get_from_index(move);
+
     int to_index = move_get_to_index(move);
-    bool turn = board_get_turn(board);
-    PieceType piece_type = board_get_piece(from_index, board);
+    PieceType piece_type = board->pieces[move_get_from_index(move)];
+    PieceType captured_piece = board->pieces[to_index];
+    if (move_get_flag(move) == EN_PASSANT_FLAG) {
+        captured_piece = piece_type < WHITE_PIECES ? BLACK_PAWN : WHITE_PAWN;
+    }
 
-    // Remove old en passant hash
-    if (board->en_passant_index != -1) {
-        board->current_zobrist_hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
+    board_push_full_move(full_move_create(move, piece_type, captured_piece), board);
+    return true;
+}
+
+/*
+ * Dispatches once on the colour of the moving piece, which is the side to move. The rest is
+ * specialised per side in board_side.h.
+ */
+void board_push_full_move(FullMove move, Board* board) {
+    if (!move_exists(full_move_get_move(move))) {
+        return;
     }
 
-    if (move_get_flag(move) == EN_PASSANT_AVAILABLE_FLAG) {
-        if (board_get_piece_color(from_index, board)) {
-            board->en_passant_index = from_index + 8;
-            board->current_zobrist_hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
-        }
-        else {
-            board->en_passant_index = from_index - 8;
-            board->current_zobrist_hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
-        }
+    if (full_move_get_piece(move) < WHITE_PIECES) {
+        push_move_white(move, board);
     }
     else {
-        board->en_passant_index = -1;
-    }
-
-    board->current_zobrist_hash ^= zobrist_castling[board->castling_rights];
-    update_castling_rights(move, piece_type, board);
-    board->current_zobrist_hash ^= zobrist_castling[board->castling_rights];
-
-    switch (move_get_flag(move)) {
-        case CASTLE_FLAG:
-            make_castle_move(move, board);
-            break;
-        case EN_PASSANT_FLAG:
-            make_en_passant_move(move, piece_type, board);
-            break;
-        case QUEEN_PROMOTION_FLAG:
-            board_set_piece(from_index, -1, board);
-            board_set_piece(to_index, turn ? WHITE_QUEEN : BLACK_QUEEN, board);
-            break;
-        case ROOK_PROMOTION_FLAG:
-            board_set_piece(from_index, -1, board);
-            board_set_piece(to_index, turn ? WHITE_ROOK : BLACK_ROOK, board);
-            break;
-        case BISHOP_PROMOTION_FLAG:
-            board_set_piece(from_index, -1, board);
-            board_set_piece(to_index, turn ? WHITE_BISHOP : BLACK_BISHOP, board);
-            break;
-        case KNIGHT_PROMOTION_FLAG:
-            board_set_piece(from_index, -1, board);
-            board_set_piece(to_index, turn ? WHITE_KNIGHT : BLACK_KNIGHT, board);
-            break;
-        default:
-            board_set_piece(from_index, -1, board);
-            board_set_piece(to_index, piece_type, board);
-            break;
+        push_move_black(move, board);
     }
 }
 
+// The turn has usually been changed back already, so the mover's colour is taken from the undo node.
 Move board_pop_move(Board* board) {
     if (board->undo_stack_size <= 0) {
         return move_create(0, 0, 0);
     }
     
     UndoNode node = undo_stack_pop(board);
-    Move move = node.move;
+    if (full_move_get_piece(node.move) < WHITE_PIECES) {
+        pop_move_white(node, board);
+    }
+    else {
+        pop_move_black(node, board);
+    }
 
-    board->current_zobrist_hash ^= zobrist_castling[board->castling_rights];
-    board->castling_rights = node.castling_rights;
-    board->current_zobrist_hash ^= zobrist_castling[board->castling_rights];
+    return full_move_get_move(node.move);
+}
 
-    if (board->en_passant_index != -1) {
-        board->current_zobrist_hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
-    }
-    board->en_passant_index = node.en_passant_index;
-    if (board->en_passant_index != -1) {
-        board->current_zobrist_hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
+// The node only saves the hash, a null move changes nothing else that the node restores.
+void board_make_null_move(Board* board) {
+    undo_stack_push(full_move_create(move_create(0, 0, 0), -1, -1), board);
+    board_change_turn(board);
+}
+
+void board_unmake_null_move(Board* board) {
+    UndoNode node = undo_stack_pop(board);
+    board->turn = !board->turn;
+    board->current_zobrist_hash = node.zobrist_hash;
+}
+
+/*
+ * Each undo node holds the hash from before its move, so this scans back through the history
+ * until a move that can't be undone over the board. Positions before a null move are not
+ * repeated by the moves actually played, so the scan stops there too.
+ */
+bool board_is_repetition(Board* board) {
+    uint64_t hash = board->current_zobrist_hash;
+
+    for (int i = board->undo_stack_size - 1 ; i >= 0 ; i--) {
+        FullMove move = board->undo_stack[i].move;
+        PieceType piece_type = full_move_get_piece(move);
+        if (!move_exists(full_move_get_move(move))) {
+            return false;
+        }
+        if (full_move_get_captured_piece(move) != -1 || piece_type == WHITE_PAWN || piece_type == BLACK_PAWN) {
+            return false;
+        }
+        if (board->undo_stack[i].zobrist_hash == hash) {
+            return true;
+        }
     }
 
-    if (move_get_flag(move) == EN_PASSANT_FLAG) {
-        int to_index = move_get_to_index(move);
-        int from_index = move_get_from_index(move);
-        int captured_index = board_get_piece_color(to_index, board) ? to_index - 8 : to_index + 8;
-        board_set_piece(from_index, node.move_piece, board);
-        board_set_piece(to_index, -1, board);
-        board_set_piece(captured_index, node.captured_piece, board);
-        return move;
+    return false;
+}
+
+void board_copy_make(FullMove move, Board* board, Position* saved) {
+    memcpy(saved->bit_boards, board->bit_boards, sizeof(saved->bit_boards));
+    saved->zobrist_hash = board->current_zobrist_hash;
+    saved->pawn_zobrist_hash = board->pawn_zobrist_hash;
+    saved->material_key = board->material_key;
+    memcpy(saved->material, board->material, sizeof(saved->material));
+    memcpy(saved->piece_square, board->piece_square, sizeof(saved->piece_square));
+    saved->en_passant_index = board->en_passant_index;
+    saved->castling_rights = board->castling_rights;
+    saved->turn = board->turn;
+    // Kept in the history for repetition detection, the rest of the node isn't used.
+    undo_stack_push(move, board);
+
+    if (full_move_get_piece(move) < WHITE_PIECES) {
+        make_move_white(move, board);
     }
-    
-    if (move_get_flag(move) == CASTLE_FLAG) {
-        unmake_castle_move(move, board);
-        return move;
+    else {
+        make_move_black(move, board);
     }
-    board_set_piece(move_get_from_index(move), node.move_piece, board);
-    board_set_piece(move_get_to_index(move), node.captured_piece, board);
-    return move;
+    board_change_turn(board);
 }
 
-PieceType board_get_piece(int index, Board* board) {
-    if (board->bit_boards[WHITE_PIECES] & (1ULL << index)) {
-        for (int type = WHITE_KING ; type <= WHITE_PAWN ; type++) {
-            if (board->bit_boards[type] & (1ULL << index)) {
-                return type;
-            }
-        }
+void board_copy_unmake(FullMove move, Board* board, Position* saved) {
+    memcpy(board->bit_boards, saved->bit_boards, sizeof(saved->bit_boards));
+    board->current_zobrist_hash = saved->zobrist_hash;
+    board->pawn_zobrist_hash = saved->pawn_zobrist_hash;
+    board->material_key = saved->material_key;
+    memcpy(board->material, saved->material, sizeof(saved->material));
+    memcpy(board->piece_square, saved->piece_square, sizeof(saved->piece_square));
+    board->en_passant_index = saved->en_passant_index;
+    board->castling_rights = saved->castling_rights;
+    board->turn = saved->turn;
+    board->undo_stack_size--;
+
+    if (full_move_get_piece(move) < WHITE_PIECES) {
+        unmake_mailbox_white(move, board);
     }
-    else if (board->bit_boards[BLACK_PIECES] & (1ULL << index)) {
-        for (int type = BLACK_KING ; type <= BLACK_PAWN ; type++) {
-            if (board->bit_boards[type] & (1ULL << index)) {
-                return type;
-            }
-        }
+    else {
+        unmake_mailbox_black(move, board);
     }
+}
 
-    return -1;
+PieceType board_get_piece(int index, Board* board) {
+    return board->pieces[index];
 }
 
 
@@ -331,7 +428,8 @@ PieceType get_black_piece_type(Board* board, int index) {
 
 
 void board_set_piece(int index, PieceType new_type, Board* board) {
-    PieceType old_type = board_get_piece(index, board);
+    PieceType old_type = board->pieces[index];
+    board->pieces[index] = new_type;
     // Remove old piece
     if (board_get_piece_color(index, board)) {
         board->bit_boards[WHITE_PIECES] &= ~(1ULL << index);
@@ -343,6 +441,12 @@ void board_set_piece(int index, PieceType new_type, Board* board) {
         board->bit_boards[old_type] &= ~(1ULL << index);
         uint64_t zobrist_number = zobrist_table[index][piece_to_zobrist_index(old_type)];
         board->current_zobrist_hash ^= zobrist_number;
+        if (old_type == WHITE_PAWN || old_type == BLACK_PAWN) {
+            board->pawn_zobrist_hash ^= zobrist_number;
+        }
+        material_key_update(old_type, __builtin_popcountll(board->bit_boards[old_type]), board);
+        board->material[old_type >= WHITE_PIECES] -= evaluate_piece_value(old_type);
+        board->piece_square[old_type >= WHITE_PIECES] -= evaluate_piece_bonus(old_type, index);
     }
 
     if (new_type == -1) {
@@ -350,9 +454,15 @@ void board_set_piece(int index, PieceType new_type, Board* board) {
     }
 
     // Set new piece
+    material_key_update(new_type, __builtin_popcountll(board->bit_boards[new_type]), board);
     board->bit_boards[new_type] |= (1ULL << index);
     uint64_t zobrist_number = zobrist_table[index][piece_to_zobrist_index(new_type)];
     board->current_zobrist_hash ^= zobrist_number;
+    if (new_type == WHITE_PAWN || new_type == BLACK_PAWN) {
+        board->pawn_zobrist_hash ^= zobrist_number;
+    }
+    board->material[new_type >= WHITE_PIECES] += evaluate_piece_value(new_type);
+    board->piece_square[new_type >= WHITE_PIECES] += evaluate_piece_bonus(new_type, index);
 
     // Possibly unnecessary to keep updated all the time.
     if (new_type >= WHITE_KING && new_type <= WHITE_PAWN) {
@@ -363,11 +473,11 @@ void board_set_piece(int index, PieceType new_type, Board* board) {
     }
 }
 
-Move* board_get_legal_moves(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares) {
+Move* board_get_legal_moves(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares) {
     return get_legal_moves(board, attack_table, move_count, attacked_squares);
 }
 
-Move* board_get_legal_captures(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares) {
+Move* board_get_legal_captures(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares) {
     return get_legal_captures(board, attack_table, move_count, attacked_squares);
 }
 
@@ -467,7 +577,6 @@ void board_set_castling_rights(char side, bool value, Board* board) {
 }
 
 void board_destroy(Board* board) {
-    free(board->undo_stack);
     free(board);
 }
 
@@ -526,84 +635,13 @@ void update_castling_rights(Move move, PieceType piece_type, Board* board) {
     }
 }
 
-void make_en_passant_move(Move move, PieceType piece_type,  Board* board) {
-    int from_index = move_get_from_index(move);
-    int to_index = move_get_to_index(move);
-    int captured_index = board_get_piece_color(from_index, board) ? to_index - 8 : to_index + 8;
-    board_set_piece(from_index, -1, board);
-    board_set_piece(captured_index, -1, board);
-    board_set_piece(to_index, piece_type, board);
+// The king lands on the c or g file, the rook comes from the a or h file of the same rank.
+static inline int castle_rook_from(int king_to_index) {
+    return king_to_index % 8 == 6 ? king_to_index + 1 : king_to_index - 2;
 }
 
-void make_castle_move(Move move, Board* board) {
-    int to_index = move_get_to_index(move);
-    switch (to_index) {
-        // White king castle
-        case 6:
-            board_set_piece(4, -1, board);
-            board_set_piece(7, -1, board);
-            board_set_piece(6, WHITE_KING, board);
-            board_set_piece(5, WHITE_ROOK, board);
-            break;
-        // White queen castle
-        case 2:
-            board_set_piece(4, -1, board);
-            board_set_piece(0, -1, board);
-            board_set_piece(2, WHITE_KING, board);
-            board_set_piece(3, WHITE_ROOK, board);
-            break;
-        // Black king castle
-        case 62:
-            board_set_piece(60, -1, board);
-            board_set_piece(63, -1, board);
-            board_set_piece(62, BLACK_KING, board);
-            board_set_piece(61, BLACK_ROOK, board);
-            break;
-        // Black queen castle
-        case 58:
-            board_set_piece(60, -1, board);
-            board_set_piece(56, -1, board);
-            board_set_piece(58, BLACK_KING, board);
-            board_set_piece(59, BLACK_ROOK, board);
-            break;
-
-        default:
-            break;
-    }
-}
-
-void unmake_castle_move(Move move, Board* board) {
-    int to_index = move_get_to_index(move);
-    switch (to_index) {
-        // White king castle
-        case 6:
-            board_set_piece(6, -1, board);
-            board_set_piece(5, -1, board);
-            board_set_piece(4, WHITE_KING, board);
-            board_set_piece(7, WHITE_ROOK, board);
-            break;
-        // White queen castle
-        case 2:
-            board_set_piece(2, -1, board);
-            board_set_piece(3, -1, board);
-            board_set_piece(4, WHITE_KING, board);
-            board_set_piece(0, WHITE_ROOK, board);
-            break;
-        // Black king castle
-        case 62:
-            board_set_piece(62, -1, board);
-            board_set_piece(61, -1, board);
-            board_set_piece(60, BLACK_KING, board);
-            board_set_piece(63, BLACK_ROOK, board);
-            break;
-        // Black queen castle
-        case 58:
-            board_set_piece(58, -1, board);
-            board_set_piece(59, -1, board);
-            board_set_piece(60, BLACK_KING, board);
-            board_set_piece(56, BLACK_ROOK, board);
-            break;
-    }
+static inline int castle_rook_to(int king_to_index) {
+    return king_to_index % 8 == 6 ? king_to_index - 1 : king_to_index + 1;
 }
 
 
@@ -653,38 +691,20 @@ void print_piece(PieceType piece_type) {
     }
 }
 
-void undo_stack_push(Move move, Board* board) {
+// The stack is sized for a whole game plus a search, board_push_move checks the game part.
+static inline void undo_stack_push(FullMove move, Board* board) {
+    assert(board->undo_stack_size < UNDO_STACK_CAPACITY);
     UndoNode new_node;
-    int to_index = move_get_to_index(move);
-    int from_index = move_get_from_index(move);
-    new_node.move_piece = (int8_t) board_get_piece(from_index, board);
     new_node.move = move;
+    new_node.zobrist_hash = board->current_zobrist_hash;
     new_node.castling_rights = board->castling_rights;
     new_node.en_passant_index = board->en_passant_index;
 
-    int captured_index;
-    if (move_get_flag(move) == EN_PASSANT_FLAG) {
-        captured_index = board_get_piece_color(from_index, board) ? to_index - 8 : to_index + 8;
-    }
-    else {
-        captured_index = to_index;
-    }
-    new_node.captured_piece = board_get_piece(captured_index, board);
-
-    if (board->undo_stack_size == board->undo_stack_capacity) {
-        board->undo_stack_capacity *= 2;
-        board->undo_stack = realloc(board->undo_stack, board->undo_stack_capacity * sizeof(UndoNode));
-    }
-
     board->undo_stack[(board->undo_stack_size)++] = new_node;
 }
 
-UndoNode undo_stack_pop(Board* board) {
-    if (board->undo_stack_size == 0) {
-        fprintf(stderr, "Undo stack is being popped empty!\n");
-        exit(1);
-    }
-
+// board_pop_move checks that the stack isn't empty.
+static inline UndoNode undo_stack_pop(Board* board) {
     return board->undo_stack[--(board->undo_stack_size)];
 }
 
@@ -9,42 +9,89 @@
 
 #define BIT_BOARD_COUNT 14
 
+// The undo stack also serves as the position history, it holds a whole game plus a search from its end.
+#define MAX_GAME_PLIES 1024
+#define MAX_SEARCH_PLIES 128
+#define UNDO_STACK_CAPACITY (MAX_GAME_PLIES + MAX_SEARCH_PLIES)
+
 
 typedef struct {
-    Move move;
+    FullMove move;              // Carries the moving and captured piece.
     int8_t en_passant_index;
-    int8_t move_piece;
-    int8_t captured_piece;
     uint8_t castling_rights;
+    uint64_t zobrist_hash;      // Hash before the move, restored on pop.
 } UndoNode;
 
 // a1 maps to the least significant bit and h8 maps to the most significant bit
 typedef struct board {
     uint64_t bit_boards[14];
+    int8_t pieces[64];          // PieceType on each square or -1 if empty, kept in sync with bit_boards.
     int8_t en_passant_index;
     bool turn;
     uint8_t castling_rights;
-    UndoNode* undo_stack;
-    int undo_stack_size;
-    int undo_stack_capacity;
     uint64_t current_zobrist_hash;
+    uint64_t pawn_zobrist_hash;  // Only the pawns, for caching pawn structure.
+    uint64_t material_key;       // Depends only on how many of each piece there are.
+    int16_t material[2];        // Piece values of white and black, kept up to date like the hash.
+    int16_t piece_square[2];    // Piece-square bonuses of white and black.
+    int undo_stack_size;
+    UndoNode undo_stack[UNDO_STACK_CAPACITY];   // Inline, so a Board can be copied as a whole.
 } Board;
 
+/*
+ * Everything a move changes except the mailbox, 152 bytes. The copy-make path saves one of these
+ * per ply instead of pushing to the undo stack, and fixes the mailbox up from the move.
+ */
+typedef struct {
+    uint64_t bit_boards[BIT_BOARD_COUNT];
+    uint64_t zobrist_hash;
+    uint64_t pawn_zobrist_hash;
+    uint64_t material_key;
+    int16_t material[2];
+    int16_t piece_square[2];
+    int8_t en_passant_index;
+    uint8_t castling_rights;
+    bool turn;
+} Position;
+
 
 Board* board_create();
 
+// Returns NULL if the FEN is malformed.
 Board* board_from_fen(char* fen, int size);
 
+// Copy with its own undo stack. Must be destroyed separately.
+Board* board_copy(Board* board);
+
 char* board_get_fen(Board* board);
 
 int board_evaluate_current(Board* board);
 
 void board_draw(Board* board);
 
-void board_push_move(Move move, Board* board);
+// Returns false and leaves the board as it is if the move doesn't exist or the game is longer
+// than MAX_GAME_PLIES. The rest of the undo stack is kept for the search.
+bool board_push_move(Move move, Board* board);
+
+// Same as board_push_move, but the pieces are taken from the move instead of the board.
+void board_push_full_move(FullMove move, Board* board);
+
+// Saves the position to saved and makes the move, including the turn change. The undo stack isn't used.
+void board_copy_make(FullMove move, Board* board, Position* saved);
+
+// Takes back a move made by board_copy_make with the same saved position.
+void board_copy_unmake(FullMove move, Board* board, Position* saved);
 
 Move board_pop_move(Board* board);
 
+// Passes the turn. Kept in the history, so repetitions aren't found across it.
+void board_make_null_move(Board* board);
+
+void board_unmake_null_move(Board* board);
+
+// True if the current position occurred before, since the last capture, pawn move or null move.
+bool board_is_repetition(Board* board);
+
 void board_set_piece(int index, PieceType type, Board* board);
 
 PieceType board_get_piece(int index, Board* board);
@@ -58,9 +105,9 @@ bool board_get_turn(Board* board);
 
 void board_set_start(Board* board);
 
-Move* board_get_legal_moves(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
+Move* board_get_legal_moves(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
 
-Move* board_get_legal_captures(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
+Move* board_get_legal_captures(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
 
 void board_set_turn(bool turn, Board* board);
 
@@ -84,5 +131,36 @@ uint64_t board_get_zobrist_hash(Board* board);
 // For initializing zobrist hash and debugging
 uint64_t calculate_zobrist_hash(Board* board);
 
+// Incrementally updated like board_get_zobrist_hash.
+uint64_t board_get_pawn_hash(Board* board);
+
+uint64_t board_get_material_key(Board* board);
+
+uint64_t calculate_pawn_hash(Board* board);
+
+uint64_t calculate_material_key(Board* board);
+
+/*
+ * Make and unmake including the turn change, as used by search and perft. Building with
+ * COPY_MAKE selects copy-make, otherwise the undo stack is used and saved is ignored.
+ */
+static inline void board_make(FullMove move, Board* board, Position* saved) {
+#ifdef COPY_MAKE
+    board_copy_make(move, board, saved);
+#else
+    board_push_full_move(move, board);
+    board_change_turn(board);
+#endif
+}
+
+static inline void board_unmake(FullMove move, Board* board, Position* saved) {
+#ifdef COPY_MAKE
+    board_copy_unmake(move, board, saved);
+#else
+    board_pop_move(board);
+    board_change_turn(board);
+#endif
+}
+
 
 #endif
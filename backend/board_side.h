@@ -0,0 +1,230 @@
+/*
+ * @brief Side specialised make and unmake.
+ *
+ * Included twice by board.c, with SIDE_IS_WHITE set to a compile-time constant for the side
+ * making the move and SIDE_FN naming the instance. Since the colour of both the mover and a
+ * captured piece is known, pieces are moved by XORing masks into the piece and colour bitboards
+ * directly instead of going through board_set_piece.
+ *
+ * @file board_side.h
+ */
+
+#define FRIENDLY(piece) ((piece) + (SIDE_IS_WHITE ? 0 : BLACK_KING - WHITE_KING))
+#define ENEMY(piece) ((piece) + (SIDE_IS_WHITE ? BLACK_KING - WHITE_KING : 0))
+#define FRIENDLY_PIECES (SIDE_IS_WHITE ? WHITE_PIECES : BLACK_PIECES)
+#define ENEMY_PIECES (SIDE_IS_WHITE ? BLACK_PIECES : WHITE_PIECES)
+#define PAWN_PUSH (SIDE_IS_WHITE ? 8 : -8)
+#define FRIENDLY_SIDE (SIDE_IS_WHITE ? 0 : 1)
+#define ENEMY_SIDE (SIDE_IS_WHITE ? 1 : 0)
+
+static void SIDE_FN(move_castle_rook)(int from_index, int to_index, Board* board);
+static inline void SIDE_FN(update_scores)(FullMove move, PieceType placed_piece, int sign, Board* board);
+static inline void SIDE_FN(update_keys)(FullMove move, PieceType placed_piece, Board* board);
+
+// Makes the move without saving anything to undo it.
+static void SIDE_FN(make_move)(FullMove move, Board* board) {
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    PieceType piece_type = full_move_get_piece(move);
+    PieceType captured_piece = full_move_get_captured_piece(move);
+    PieceType placed_piece = piece_type;
+    uint64_t hash = board->current_zobrist_hash;
+
+    // Remove old en passant hash
+    if (board->en_passant_index != -1) {
+        hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
+    }
+
+    if (flag == EN_PASSANT_AVAILABLE_FLAG) {
+        board->en_passant_index = from_index + PAWN_PUSH;
+        hash ^= zobrist_en_passant_file[board->en_passant_index % 8];
+    }
+    else {
+        board->en_passant_index = -1;
+    }
+
+    hash ^= zobrist_castling[board->castling_rights];
+    update_castling_rights(move, piece_type, board);
+    hash ^= zobrist_castling[board->castling_rights];
+
+    if (captured_piece != -1) {
+        int captured_index = flag == EN_PASSANT_FLAG ? to_index - PAWN_PUSH : to_index;
+        uint64_t captured_bit = 1ULL << captured_index;
+        board->bit_boards[captured_piece] ^= captured_bit;
+        board->bit_boards[ENEMY_PIECES] ^= captured_bit;
+        board->pieces[captured_index] = -1;
+        hash ^= zobrist_table[captured_index][piece_to_zobrist_index(captured_piece)];
+    }
+
+    switch (flag) {
+        case CASTLE_FLAG:
+            SIDE_FN(move_castle_rook)(castle_rook_from(to_index), castle_rook_to(to_index), board);
+            hash ^= zobrist_table[castle_rook_from(to_index)][piece_to_zobrist_index(FRIENDLY(WHITE_ROOK))];
+            hash ^= zobrist_table[castle_rook_to(to_index)][piece_to_zobrist_index(FRIENDLY(WHITE_ROOK))];
+            break;
+        case QUEEN_PROMOTION_FLAG:
+            placed_piece = FRIENDLY(WHITE_QUEEN);
+            break;
+        case ROOK_PROMOTION_FLAG:
+            placed_piece = FRIENDLY(WHITE_ROOK);
+            break;
+        case BISHOP_PROMOTION_FLAG:
+            placed_piece = FRIENDLY(WHITE_BISHOP);
+            break;
+        case KNIGHT_PROMOTION_FLAG:
+            placed_piece = FRIENDLY(WHITE_KNIGHT);
+            break;
+        default:
+            break;
+    }
+
+    // For everything but promotions this is a single from|to mask on the piece's bitboard.
+    board->bit_boards[piece_type] ^= 1ULL << from_index;
+    board->bit_boards[placed_piece] ^= 1ULL << to_index;
+    board->bit_boards[FRIENDLY_PIECES] ^= (1ULL << from_index) | (1ULL << to_index);
+    board->pieces[from_index] = -1;
+    board->pieces[to_index] = placed_piece;
+    hash ^= zobrist_table[from_index][piece_to_zobrist_index(piece_type)]
+          ^ zobrist_table[to_index][piece_to_zobrist_index(placed_piece)];
+
+    board->current_zobrist_hash = hash;
+    SIDE_FN(update_scores)(move, placed_piece, 1, board);
+    SIDE_FN(update_keys)(move, placed_piece, board);
+}
+
+static void SIDE_FN(push_move)(FullMove move, Board* board) {
+    undo_stack_push(move, board);
+    SIDE_FN(make_move)(move, board);
+}
+
+// The hash is restored from the undo node, so only the pieces have to be moved back.
+static void SIDE_FN(pop_move)(UndoNode node, Board* board) {
+    FullMove move = node.move;
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    PieceType piece_type = full_move_get_piece(move);
+    PieceType captured_piece = full_move_get_captured_piece(move);
+    PieceType placed_piece = board->pieces[to_index];
+
+    SIDE_FN(update_scores)(move, placed_piece, -1, board);
+    SIDE_FN(update_keys)(move, placed_piece, board);
+    // The hash was saved with the mover to move, callers usually pop before changing the turn back.
+    board->current_zobrist_hash = node.zobrist_hash;
+    if (board->turn != SIDE_IS_WHITE) {
+        board->current_zobrist_hash ^= zobrist_side_to_move;
+    }
+    board->castling_rights = node.castling_rights;
+    board->en_passant_index = node.en_passant_index;
+
+    board->bit_boards[placed_piece] ^= 1ULL << to_index;
+    board->bit_boards[piece_type] ^= 1ULL << from_index;
+    board->bit_boards[FRIENDLY_PIECES] ^= (1ULL << from_index) | (1ULL << to_index);
+    board->pieces[to_index] = -1;
+    board->pieces[from_index] = piece_type;
+
+    if (flag == CASTLE_FLAG) {
+        SIDE_FN(move_castle_rook)(castle_rook_to(to_index), castle_rook_from(to_index), board);
+    }
+
+    if (captured_piece != -1) {
+        int captured_index = flag == EN_PASSANT_FLAG ? to_index - PAWN_PUSH : to_index;
+        uint64_t captured_bit = 1ULL << captured_index;
+        board->bit_boards[captured_piece] ^= captured_bit;
+        board->bit_boards[ENEMY_PIECES] ^= captured_bit;
+        board->pieces[captured_index] = captured_piece;
+    }
+}
+
+static void SIDE_FN(move_castle_rook)(int from_index, int to_index, Board* board) {
+    uint64_t from_to = (1ULL << from_index) | (1ULL << to_index);
+    board->bit_boards[FRIENDLY(WHITE_ROOK)] ^= from_to;
+    board->bit_boards[FRIENDLY_PIECES] ^= from_to;
+    board->pieces[from_index] = -1;
+    board->pieces[to_index] = FRIENDLY(WHITE_ROOK);
+}
+
+// Adds (sign 1) or takes back (sign -1) the material and piece-square change of the move.
+static inline void SIDE_FN(update_scores)(FullMove move, PieceType placed_piece, int sign, Board* board) {
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    PieceType piece_type = full_move_get_piece(move);
+    PieceType captured_piece = full_move_get_captured_piece(move);
+
+    int bonus = evaluate_piece_bonus(placed_piece, to_index) - evaluate_piece_bonus(piece_type, from_index);
+    if (placed_piece != piece_type) {
+        board->material[FRIENDLY_SIDE] += sign * (evaluate_piece_value(placed_piece) - evaluate_piece_value(piece_type));
+    }
+    else if (flag == CASTLE_FLAG) {
+        bonus += evaluate_piece_bonus(FRIENDLY(WHITE_ROOK), castle_rook_to(to_index))
+               - evaluate_piece_bonus(FRIENDLY(WHITE_ROOK), castle_rook_from(to_index));
+    }
+    board->piece_square[FRIENDLY_SIDE] += sign * bonus;
+
+    if (captured_piece != -1) {
+        int captured_index = flag == EN_PASSANT_FLAG ? to_index - PAWN_PUSH : to_index;
+        board->material[ENEMY_SIDE] -= sign * evaluate_piece_value(captured_piece);
+        board->piece_square[ENEMY_SIDE] -= sign * evaluate_piece_bonus(captured_piece, captured_index);
+    }
+}
+
+/*
+ * XORs the pawn hash and material key changes of the move. Called with the move made, which
+ * both make_move and pop_move do, so calling it again takes the change back.
+ */
+static inline void SIDE_FN(update_keys)(FullMove move, PieceType placed_piece, Board* board) {
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    PieceType piece_type = full_move_get_piece(move);
+    PieceType captured_piece = full_move_get_captured_piece(move);
+
+    if (piece_type == FRIENDLY(WHITE_PAWN)) {
+        board->pawn_zobrist_hash ^= zobrist_table[from_index][piece_to_zobrist_index(FRIENDLY(WHITE_PAWN))];
+        if (placed_piece == piece_type) {
+            board->pawn_zobrist_hash ^= zobrist_table[to_index][piece_to_zobrist_index(FRIENDLY(WHITE_PAWN))];
+        }
+        else {
+            material_key_update(piece_type, __builtin_popcountll(board->bit_boards[piece_type]), board);
+            material_key_update(placed_piece, __builtin_popcountll(board->bit_boards[placed_piece]) - 1, board);
+        }
+    }
+
+    if (captured_piece != -1) {
+        if (captured_piece == ENEMY(WHITE_PAWN)) {
+            int captured_index = flag == EN_PASSANT_FLAG ? to_index - PAWN_PUSH : to_index;
+            board->pawn_zobrist_hash ^= zobrist_table[captured_index][piece_to_zobrist_index(ENEMY(WHITE_PAWN))];
+        }
+        material_key_update(captured_piece, __builtin_popcountll(board->bit_boards[captured_piece]), board);
+    }
+}
+
+// Copy-make restores the bitboards wholesale, only the mailbox has to be put back by hand.
+static void SIDE_FN(unmake_mailbox)(FullMove move, Board* board) {
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    PieceType captured_piece = full_move_get_captured_piece(move);
+
+    board->pieces[from_index] = full_move_get_piece(move);
+    board->pieces[to_index] = captured_piece;
+
+    if (flag == EN_PASSANT_FLAG) {
+        board->pieces[to_index] = -1;
+        board->pieces[to_index - PAWN_PUSH] = captured_piece;
+    }
+    else if (flag == CASTLE_FLAG) {
+        board->pieces[castle_rook_to(to_index)] = -1;
+        board->pieces[castle_rook_from(to_index)] = FRIENDLY(WHITE_ROOK);
+    }
+}
+
+#undef FRIENDLY
+#undef ENEMY
+#undef FRIENDLY_PIECES
+#undef ENEMY_PIECES
+#undef PAWN_PUSH
+#undef FRIENDLY_SIDE
+#undef ENEMY_SIDE
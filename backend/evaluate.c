@@ -2,8 +2,9 @@
 #include "piece.h"
 #include <stdint.h>
 #include <stdio.h>
+#include <assert.h>
+#include "evaluate.h"
 
-int get_total_piece_value(uint64_t pieces, Board* board);
 int get_mobility_score(uint64_t pieces, Board* board);
 int get_piece_value(PieceType type, Board* board);
 int get_piece_bonus(PieceType type, int index);
@@ -82,16 +83,32 @@ static const int WHITE_KING_BONUS[64] = {
     20, 30, 10,  0,  0, 10, 30, 20
 };
 
+const int PIECE_VALUES[6] = {
+    0, QUEEN_VALUE, ROOK_VALUE, BISHOP_VALUE, KNIGHT_VALUE, PAWN_VALUE
+};
+
+const int* const PIECE_BONUS_TABLES[6] = {
+    WHITE_KING_BONUS,
+    WHITE_QUEEN_BONUS,
+    WHITE_ROOK_BONUS,
+    WHITE_BISHOP_BONUS,
+    WHITE_KNIGHT_BONUS,
+    WHITE_PAWN_BONUS,
+};
+
 // Positive value = good for white. Negative value = good for black.
 int evaluate_board(Board* board) {
-    int white_score = 0;
-    int black_score = 0;
-
     uint64_t white_pieces = board->bit_boards[WHITE_PIECES];
     uint64_t black_pieces = board->bit_boards[BLACK_PIECES];
 
-    white_score += get_total_piece_value(white_pieces, board);
-    black_score += get_total_piece_value(black_pieces, board);
+    // Material and piece-square bonuses are kept up to date by the board.
+    int white_score = board->material[0] + board->piece_square[0];
+    int black_score = board->material[1] + board->piece_square[1];
+
+#ifdef EVAL_DEBUG
+    assert(white_score == get_total_piece_value(white_pieces, board));
+    assert(black_score == get_total_piece_value(black_pieces, board));
+#endif
 
     white_score += get_mobility_score(white_pieces, board);
     black_score += get_mobility_score(black_pieces, board);
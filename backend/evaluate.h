@@ -4,9 +4,27 @@
 
 #include "board.h"
 
+// Indexed by white piece type, the tables are written from white's side with a8 first.
+extern const int PIECE_VALUES[6];
+extern const int* const PIECE_BONUS_TABLES[6];
+
 // Returns how good the positioin is for white.
 int evaluate_board(Board* board);
 
 int get_piece_value(PieceType type, Board* board);
 
+// Full recompute of the material and piece-square bonus of one side, what Board keeps incrementally.
+int get_total_piece_value(uint64_t pieces, Board* board);
+
+static inline int evaluate_piece_value(PieceType type) {
+    return PIECE_VALUES[type < WHITE_PIECES ? type : type - BLACK_KING];
+}
+
+static inline int evaluate_piece_bonus(PieceType type, int index) {
+    if (type < WHITE_PIECES) {
+        return PIECE_BONUS_TABLES[type][index ^ 56];
+    }
+    return PIECE_BONUS_TABLES[type - BLACK_KING][index];
+}
+
 #endif
\ No newline at end of file
@@ -23,13 +23,11 @@ Board* fen_to_board(char* fen, int size) {
     Board* board = board_create();
     int current_index = 0;
 
-    if (parse_piece_positions(fen, size, board, &current_index) == -1) {
-        return NULL;
-    }
-    if (parse_active_color(fen, size, board, &current_index) == -1) {
-        return NULL;
-    }
-    if (parse_castling_rights(fen, size, board, &current_index) == -1) {
+    if (parse_piece_positions(fen, size, board, &current_index) == -1 ||
+        parse_active_color(fen, size, board, &current_index) == -1 ||
+        parse_castling_rights(fen, size, board, &current_index) == -1 ||
+        parse_en_pessent_targets(fen, size, board, &current_index) == -1) {
+        board_destroy(board);
         return NULL;
     }
 
@@ -218,16 +216,22 @@ int add_fen_char(char* fen, char c, int* current_index) {
 
 /* ------------------ fen to board ------------------*/
 
-// Not implemented!!!!
+// The clocks after the en passant square are ignored, so it may also end the string.
 int parse_en_pessent_targets(char* fen, int size, Board* board, int* current_index) {
-    while (fen[*current_index] != ' ') {
-        if (++(*current_index) >= size) {
-            return -1;
-        }
+    if (*current_index >= size || fen[*current_index] == '-') {
+        return 0;
     }
-    if (++(*current_index) >= size) {
+    if (*current_index + 1 >= size) {
+        return -1;
+    }
+
+    int file = fen[*current_index] - 'a';
+    int rank = fen[*current_index + 1] - '1';
+    if (file < 0 || file > 7 || (rank != 2 && rank != 5)) {
         return -1;
     }
+    board->en_passant_index = rank * 8 + file;
+    *current_index += 2;
 
     return 0;
 }
@@ -7,6 +7,9 @@
  * 
  */
 
+// For clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include "board.h"
 #include "move.h"
@@ -16,17 +19,21 @@
 #include "bitboard.h"
 #include "evaluate.h"
 #include "search.h"
+#include "perft.h"
 #include <time.h>
+#include <inttypes.h>
 
 Move read_move();
 Move parse_move(char* string);
 void print_move(Move move);
-uint32_t move_generation_test(Board* board, AttackTable* attack_table, int depth);
 void print_moves(Move* moves, int move_count);
 
 void run_uci();
+void run_perft(int argc, char* argv[]);
+void run_bench(int argc, char* argv[]);
 void print_uci_move(Move move);
-void uci_parse_pos(Board* board, AttackTable* attack_table, char* current_line);
+void uci_parse_pos(Board* board, const AttackTable* attack_table, char* current_line);
+void uci_set_option(TTable* t_table, char* current_line);
 
 
 int main(int argc, char* argv[]) {
@@ -34,31 +41,169 @@ int main(int argc, char* argv[]) {
         run_uci();
         exit(0);
     }
-    AttackTable* attack_table = attack_table_create();
-    char* fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    //char* fen = "r4k1r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/5Q1p/PPPBBPPP/RN2K2R w QK - 0 0";
+    if (argc >= 3 && (strcmp(argv[1], "perft") == 0 || strcmp(argv[1], "divide") == 0)) {
+        run_perft(argc, argv);
+        exit(0);
+    }
+    if (strcmp(argv[1], "bench") == 0) {
+        run_bench(argc, argv);
+        exit(0);
+    }
 
+    printf("Usage: %s [perft|divide [-t threads] [-s split_depth] [-H hash_MB] <depth> [fen]]\n", argv[0]);
+    printf("       %s bench [depth] [threads]\n", argv[0]);
+    return 1;
+}
+
+/*
+ * kungknuffaren perft [-t threads] [-s split_depth] [-H hash_MB] <depth> [fen]
+ * kungknuffaren divide [-t threads] [-s split_depth] [-H hash_MB] <depth> [fen]
+ * 
+ * The FEN may be given as one quoted argument or as separate arguments. Subtree counts are
+ * cached in a perft table of hash_MB if it is given.
+ */
+void run_perft(int argc, char* argv[]) {
+    bool divide = strcmp(argv[1], "divide") == 0;
+    int thread_count = 1;
+    int split_depth = 1;
+    int hash_MB = 0;
+
+    int arg = 2;
+    while (arg + 1 < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-t") == 0) {
+            thread_count = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "-s") == 0) {
+            split_depth = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "-H") == 0) {
+            // Same range as the UCI Hash option.
+            hash_MB = atoi(argv[arg + 1]);
+            if (hash_MB < TT_MIN_SIZE_MB) {
+                hash_MB = TT_MIN_SIZE_MB;
+            }
+            if (hash_MB > TT_MAX_SIZE_MB) {
+                hash_MB = TT_MAX_SIZE_MB;
+            }
+        }
+        arg += 2;
+    }
+    if (arg >= argc) {
+        printf("Missing depth\n");
+        return;
+    }
+    int depth = atoi(argv[arg++]);
+
+    char fen[256] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    if (arg < argc) {
+        fen[0] = '\0';
+        for (int i = arg ; i < argc ; i++) {
+            strncat(fen, argv[i], sizeof(fen) - strlen(fen) - 2);
+            strcat(fen, " ");
+        }
+    }
+
+    zobrist_init();
+    const AttackTable* attack_table = attack_table_create();
     Board* board = board_from_fen(fen, strlen(fen));
+    if (!board) {
+        printf("Invalid FEN: %s\n", fen);
+        return;
+    }
+
+    PerftTable* table = NULL;
+    if (hash_MB > 0) {
+        table = perft_table_create(hash_MB);
+        if (!table) {
+            printf("Could not allocate %d MB for the perft table\n", hash_MB);
+            board_destroy(board);
+            return;
+        }
+    }
 
-    double start_time = clock();
-    uint32_t count = move_generation_test(board, attack_table, 5);
-    double end_time = clock();
-    double elapsed_time = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    // Wall time, clock() would add up the time of all threads.
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    uint64_t count;
+    if (thread_count > 1 || table) {
+        count = perft_parallel(board, attack_table, table, depth, split_depth, thread_count, divide);
+    }
+    else {
+        count = divide ? perft_divide(board, attack_table, depth) : perft(board, attack_table, depth);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double elapsed_time = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 
-    printf("Count: %d\n", count);
+    printf("Nodes: %" PRIu64 "\n", count);
     printf("Time: %.3f\n", elapsed_time);
-    printf("Nodes per second: %.f\n", count/elapsed_time);
+    printf("Nodes per second: %.f\n", count / elapsed_time);
 
+    if (table) {
+        perft_table_destroy(table);
+    }
     board_destroy(board);
-    attack_table_destroy(attack_table);
+}
+
+/*
+ * kungknuffaren bench [depth] [threads]
+ * 
+ * Searches a fixed set of positions to the given depth and prints the total node count and
+ * speed. Used to compare build variants such as make COPY_MAKE=1, and thread counts.
+ */
+void run_bench(int argc, char* argv[]) {
+    char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    };
+    int fen_count = sizeof(fens) / sizeof(fens[0]);
+    int depth = argc >= 3 ? atoi(argv[2]) : 10;
+    search_set_thread_count(argc >= 4 ? atoi(argv[3]) : 1);
+
+    zobrist_init();
+    const AttackTable* attack_table = attack_table_create();
+    TTable* t_table = tt_create(TT_DEFAULT_SIZE_MB);
+
+    uint64_t total_nodes = 0;
+    double total_time = 0;
+    for (int i = 0 ; i < fen_count ; i++) {
+        Board* board = board_from_fen(fens[i], strlen(fens[i]));
+        // Every position starts from an empty table so the results don't depend on the order.
+        tt_clear(t_table);
+
+        struct timespec start_time, end_time;
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        Move best_move = search_best_move(board, attack_table, t_table, depth, 0);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        double elapsed_time = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+        char move_string[MOVE_STRING_SIZE];
+        move_to_string(best_move, move_string);
+        printf("%d: %s %d nodes %.3f s\n", i + 1, move_string, search_get_node_count(), elapsed_time);
+
+        total_nodes += search_get_node_count();
+        total_time += elapsed_time;
+        board_destroy(board);
+    }
+
+    printf("Nodes: %" PRIu64 "\n", total_nodes);
+    printf("Time: %.3f\n", total_time);
+    printf("Nodes per second: %.f\n", total_nodes / total_time);
+
+    tt_destroy(t_table);
 }
 
 
 void run_uci() {
     char* start_fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     Board* board = board_from_fen(start_fen, strlen(start_fen));
-    AttackTable* attack_table = attack_table_create();
+    const AttackTable* attack_table = attack_table_create();
     zobrist_init();
+    // Kept for the whole session, so what was learnt searching one move helps with the next.
+    TTable* t_table = tt_create(TT_DEFAULT_SIZE_MB);
     char current_line[4096];
 
     while (fgets(current_line, sizeof(current_line), stdin)) {
@@ -67,6 +212,9 @@ void run_uci() {
         if (strcmp(current_line, "uci") == 0) {
             printf("id Kungknuffaren\n");
             printf("id Algot Heimerson\n");
+            printf("option name Threads type spin default 1 min 1 max 256\n");
+            printf("option name Hash type spin default %d min %d max %d\n", TT_DEFAULT_SIZE_MB, TT_MIN_SIZE_MB, TT_MAX_SIZE_MB);
+            printf("option name Clear Hash type button\n");
             printf("uciok\n");
             fflush(stdout);
         }
@@ -80,8 +228,17 @@ void run_uci() {
             uci_parse_pos(board, attack_table, current_line);
             board_draw(board);
         }
+        else if (strncmp(current_line, "setoption", 9) == 0) {
+            uci_set_option(t_table, current_line);
+        }
+        else if (strcmp(current_line, "ucinewgame") == 0) {
+            tt_clear(t_table);
+        }
         else if (strncmp(current_line, "go", 2) == 0) {
-            Move best_move = search_best_move(board, attack_table, 6, 0);
+            Move best_move = search_best_move(board, attack_table, t_table, 6, 0);
+            double elapsed_time = search_get_elapsed_time();
+            printf("info nodes %d nps %.f time %.f\n", search_get_node_count(),
+                   search_get_node_count() / elapsed_time, elapsed_time * 1000);
             print_uci_move(best_move);
             fflush(stdout);
         }
@@ -90,10 +247,10 @@ void run_uci() {
         }
     }
     board_destroy(board);
-    attack_table_destroy(attack_table);
+    tt_destroy(t_table);
 }
 
-void uci_parse_pos(Board* board, AttackTable* attack_table, char* current_line) {
+void uci_parse_pos(Board* board, const AttackTable* attack_table, char* current_line) {
     if (strncmp(current_line, "position startpos", 17) == 0 &&
         strstr(current_line, "moves") == NULL) {
         return;
@@ -106,23 +263,56 @@ void uci_parse_pos(Board* board, AttackTable* attack_table, char* current_line)
     char* current_move_str = strtok(&line_copy[23], " ");
 
     while (current_move_str) {
-        int move_count = 0;
         printf("Current move string: %s\n", current_move_str);
         Move move = parse_move(current_move_str);
         // Compare to legal moves to get the correct move flag
         uint64_t attacked_squares = 0ULL;
-        Move* legal_moves = board_get_legal_moves(board, attack_table, &move_count, &attacked_squares);
+        MoveList legal_moves;
+        generate_legal_moves(board, attack_table, &legal_moves, &attacked_squares);
 
-        for (int i = 0 ; i < move_count ; i++) {
-            if (move_comp_from_to(move, legal_moves[i])) {
-                move = legal_moves[i];
+        for (int i = 0 ; i < legal_moves.count ; i++) {
+            if (move_comp_from_to(move, legal_moves.moves[i])) {
+                move = full_move_get_move(legal_moves.moves[i]);
             }
         }
 
-        board_push_move(move, board);
+        if (!board_push_move(move, board)) {
+            printf("info string ignoring the moves from %s on\n", current_move_str);
+            break;
+        }
         board_change_turn(board);
         current_move_str = strtok(NULL, " ");
-        free(legal_moves);
+    }
+}
+
+// setoption name <name> [value <value>]
+void uci_set_option(TTable* t_table, char* current_line) {
+    if (strcmp(current_line, "setoption name Clear Hash") == 0) {
+        tt_clear(t_table);
+        return;
+    }
+
+    char* value = strstr(current_line, " value ");
+    if (!value) {
+        return;
+    }
+    value += strlen(" value ");
+
+    if (strncmp(current_line, "setoption name Threads ", 23) == 0) {
+        search_set_thread_count(atoi(value));
+    }
+    else if (strncmp(current_line, "setoption name Hash ", 20) == 0) {
+        int size_MB = atoi(value);
+        if (size_MB < TT_MIN_SIZE_MB) {
+            size_MB = TT_MIN_SIZE_MB;
+        }
+        if (size_MB > TT_MAX_SIZE_MB) {
+            size_MB = TT_MAX_SIZE_MB;
+        }
+        if (!tt_resize(t_table, size_MB)) {
+            printf("info string could not allocate %d MB for the hash table, keeping the old one\n", size_MB);
+            fflush(stdout);
+        }
     }
 }
 
@@ -138,12 +328,10 @@ Move parse_move(char* move_str) {
 }
 
 void print_uci_move(Move move) {
-    int from_rank = move_get_from_index(move) / 8 + 1;
-    char from_file = move_get_from_index(move) % 8 + 'a';
-    int to_rank = move_get_to_index(move) / 8 + 1;
-    char to_file = move_get_to_index(move) % 8 + 'a';
+    char move_string[MOVE_STRING_SIZE];
+    move_to_string(move, move_string);
 
-    printf("bestmove %c%d%c%d\n", from_file, from_rank, to_file, to_rank);
+    printf("bestmove %s\n", move_string);
 }
 
 void print_moves(Move* moves, int move_count) {
@@ -152,28 +340,6 @@ void print_moves(Move* moves, int move_count) {
     }
 }
 
-uint32_t move_generation_test(Board* board, AttackTable* attack_table, int depth) {
-    if (depth == 0) {
-        return 1;
-    }
-    
-    int move_count = 0;
-    uint64_t attacked_squares = 0ULL;
-    Move* moves = get_legal_moves(board, attack_table, &move_count, &attacked_squares);
-    uint32_t total_moves = 0;
-
-    for (int i = 0 ; i < move_count ; i++) {
-        board_push_move(moves[i], board);
-        board_change_turn(board);
-        total_moves += move_generation_test(board, attack_table, depth - 1);
-        board_pop_move(board);
-        board_change_turn(board);
-    }
-
-    free(moves);
-    return total_moves;
-}
-
 void print_legal_moves(Move* moves) {
     int i = 0;
     while (move_exists(moves[i])) {
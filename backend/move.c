@@ -37,3 +37,21 @@ void move_print(Move move) {
     printf("------------------ \n");
 }
 
+void move_to_string(Move move, char* string) {
+    int from_index = move_get_from_index(move);
+    int to_index = move_get_to_index(move);
+
+    string[0] = 'a' + from_index % 8;
+    string[1] = '1' + from_index / 8;
+    string[2] = 'a' + to_index % 8;
+    string[3] = '1' + to_index / 8;
+
+    switch (move_get_flag(move)) {
+        case QUEEN_PROMOTION_FLAG:  string[4] = 'q'; break;
+        case ROOK_PROMOTION_FLAG:   string[4] = 'r'; break;
+        case BISHOP_PROMOTION_FLAG: string[4] = 'b'; break;
+        case KNIGHT_PROMOTION_FLAG: string[4] = 'n'; break;
+        default:                    string[4] = '\0'; break;
+    }
+    string[5] = '\0';
+}
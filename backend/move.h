@@ -29,6 +29,18 @@ typedef enum {
 
 typedef uint16_t Move;
 
+/*
+ * Move used inside the engine: the Move in the low 16 bits, then the moving piece and the
+ * captured piece, 4 bits each. The generator fills them in, so make/unmake and move ordering
+ * don't have to look them up on the board again. UCI, the frontend and the transposition table
+ * use the compact Move.
+ */
+typedef uint32_t FullMove;
+
+#define FULL_MOVE_NO_PIECE 0xF
+
+#define MOVE_STRING_SIZE 6
+
 int move_get_from_index(Move move);
 
 MoveFlag move_get_flag(Move move);
@@ -43,4 +55,26 @@ bool move_comp_from_to(Move m1, Move m2);
 
 void move_print(Move move);
 
+// Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q". Needs MOVE_STRING_SIZE chars.
+void move_to_string(Move move, char* string);
+
+// captured_piece is -1 if nothing is captured.
+static inline FullMove full_move_create(Move move, PieceType moving_piece, PieceType captured_piece) {
+    return move | (moving_piece & 0xF) << 16 | (captured_piece & 0xF) << 20;
+}
+
+static inline Move full_move_get_move(FullMove move) {
+    return (Move) move;
+}
+
+static inline PieceType full_move_get_piece(FullMove move) {
+    return (PieceType) (move >> 16 & 0xF);
+}
+
+// -1 if the move isn't a capture.
+static inline PieceType full_move_get_captured_piece(FullMove move) {
+    int captured_piece = move >> 20 & 0xF;
+    return (PieceType) (captured_piece == FULL_MOVE_NO_PIECE ? -1 : captured_piece);
+}
+
 #endif
\ No newline at end of file
@@ -5,18 +5,84 @@
 #include "move.h"
 #include "board.h"
 
+#define MAX_LEGAL_MOVES 218
+
+/*
+ * Fixed size move storage owned by the caller, intended to live on the stack.
+ * The moves are followed by a non-existing move.
+ */
+typedef struct {
+    FullMove moves[MAX_LEGAL_MOVES + 1];
+    int count;
+} MoveList;
+
+typedef enum {
+    GENERATE_ALL,
+    GENERATE_CAPTURES,     // Captures, en passant and promotions
+    GENERATE_QUIETS,       // Everything else, including castling
+} GenerationType;
+
+/*
+ * Everything about the side to move's king that legal move generation needs. Computing it
+ * is the expensive part, so it can be shared between several generation calls.
+ */
+typedef struct {
+    int king_index;
+    uint64_t attacked_squares;
+    uint64_t king_attackers;
+    uint64_t pinned_pieces;
+    uint64_t squares_blocking_king;
+} CheckInfo;
+
 /**
- * @brief Get the legal moves based on the board's internal turn.
+ * @brief Fills the move list with the legal moves based on the board's internal turn.
+ * 
+ * @param board             The board
+ * @param attack_table      The attack table. 
+ * @param move_list         The move list to fill. Previous content is overwritten.
+ * @param attacked_squares  Set to the squares attacked by the opponent.
+ */
+void generate_legal_moves(Board* board, const AttackTable* attack_table, MoveList* move_list, uint64_t* attacked_squares);
+
+void generate_legal_captures(Board* board, const AttackTable* attack_table, MoveList* move_list, uint64_t* attacked_squares);
+
+void generate_moves(Board* board, const AttackTable* attack_table, MoveList* move_list, uint64_t* attacked_squares, GenerationType type);
+
+void get_check_info(Board* board, const AttackTable* attack_table, CheckInfo* check_info);
+
+// Legal moves of the given type, only for pieces on from_squares.
+void generate_moves_from_squares(Board* board, 
+                                 const AttackTable* attack_table, 
+                                 CheckInfo* check_info, 
+                                 MoveList* move_list, 
+                                 GenerationType type, 
+                                 uint64_t from_squares);
+
+/*
+ * The full move matching move if it is legal and of the given type, else a non-existing move.
+ * Used to validate hash and killer moves.
+ */
+FullMove get_legal_full_move(Board* board, const AttackTable* attack_table, CheckInfo* check_info, Move move, GenerationType type);
+
+/**
+ * @brief Get the legal moves based on the board's internal turn. Allocates, mainly for the frontend.
  * 
  * @param board         The board
  * @param attack_table  The attack table. 
- * @return              Array containing legal moves. Ends with an non-existing move. 
+ * @return              Array containing legal moves. Ends with an non-existing move. Must be freed.
  */
-Move* get_legal_moves(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
+Move* get_legal_moves(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
 
-Move* get_legal_captures(Board* board, AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
+Move* get_legal_captures(Board* board, const AttackTable* attack_table, int* move_count, uint64_t* attacked_squares);
 
-uint64_t get_king_attackers(Board* board, int king_index, AttackTable* attack_table, uint64_t* all_attacks);
+/**
+ * @brief Computes every square attacked by the opponent in one pass over the piece sets.
+ * 
+ * @param king_index        Index of the side to move's king. It is treated as empty.
+ * @param attacked_squares  Set to the squares attacked by the opponent.
+ * @return                  Bitboard of the opponent pieces giving check.
+ */
+uint64_t get_attack_map(Board* board, int king_index, const AttackTable* attack_table, uint64_t* attacked_squares);
 
 
 #endif
\ No newline at end of file
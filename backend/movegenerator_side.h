@@ -0,0 +1,417 @@
+/*
+ * @brief Side to move dependent parts of the move generator.
+ *
+ * Included twice by movegenerator.c, with SIDE_IS_WHITE set to a compile-time constant and
+ * SIDE_FN naming the instance, so every turn check below folds away. The external functions
+ * pick the instance once per call.
+ *
+ * @file movegenerator_side.h
+ */
+
+#define FRIENDLY(piece) ((piece) + (SIDE_IS_WHITE ? 0 : BLACK_KING - WHITE_KING))
+#define ENEMY(piece) ((piece) + (SIDE_IS_WHITE ? BLACK_KING - WHITE_KING : 0))
+#define FRIENDLY_PIECES (SIDE_IS_WHITE ? WHITE_PIECES : BLACK_PIECES)
+#define ENEMY_PIECES (SIDE_IS_WHITE ? BLACK_PIECES : WHITE_PIECES)
+#define PAWN_PUSH (SIDE_IS_WHITE ? 8 : -8)
+
+static uint64_t SIDE_FN(get_pinned_pieces)(Board* board, int king_index, const AttackTable* attack_table);
+static void SIDE_FN(add_castle_moves)(Board* board, FullMove* legal_moves, int* move_count, uint64_t attacked_squares);
+static void SIDE_FN(add_en_passant_moves)(Board* board,
+                                          const AttackTable* attack_table,
+                                          FullMove* moves, int* move_count,
+                                          CheckInfo* check_info,
+                                          uint64_t from_squares);
+static bool SIDE_FN(check_en_passant_legality)(Board* board, const AttackTable* attack_table, int king_index, int from_index, int to_index);
+static void SIDE_FN(add_pawn_moves)(Board* board,
+                                    const AttackTable* attack_table,
+                                    FullMove* moves,
+                                    int* move_count,
+                                    CheckInfo* check_info,
+                                    uint64_t pawn_target_squares,
+                                    uint64_t from_squares);
+static void SIDE_FN(add_pawn_set_moves)(Board* board, FullMove* moves, int* move_count, uint64_t pawns, uint64_t target_squares);
+static void SIDE_FN(get_moves_from_bit_board)(Board* board,
+                                              FullMove* moves,
+                                              int* current_index,
+                                              const AttackTable* attack_table,
+                                              CheckInfo* check_info,
+                                              uint64_t target_squares,
+                                              uint64_t from_squares);
+
+
+static uint64_t SIDE_FN(get_attack_map)(Board* board, int king_index, const AttackTable* attack_table, uint64_t* attacked_squares) {
+    uint64_t king = 1ULL << king_index;
+    uint64_t occupancy = (board->bit_boards[WHITE_PIECES] | board->bit_boards[BLACK_PIECES]) & ~king;
+
+    uint64_t pawns = board->bit_boards[ENEMY(WHITE_PAWN)];
+    uint64_t knights = board->bit_boards[ENEMY(WHITE_KNIGHT)];
+    uint64_t queens = board->bit_boards[ENEMY(WHITE_QUEEN)];
+    uint64_t diagonal_sliders = board->bit_boards[ENEMY(WHITE_BISHOP)] | queens;
+    uint64_t straight_sliders = board->bit_boards[ENEMY(WHITE_ROOK)] | queens;
+    int enemy_king_index = __builtin_ctzll(board->bit_boards[ENEMY(WHITE_KING)]);
+
+    uint64_t attacks = attack_table->common->king_table[enemy_king_index];
+
+    if (SIDE_IS_WHITE) {
+        attacks |= ((pawns >> 9) & NOT_H_FILE) | ((pawns >> 7) & NOT_A_FILE);
+    }
+    else {
+        attacks |= ((pawns << 7) & NOT_H_FILE) | ((pawns << 9) & NOT_A_FILE);
+    }
+
+    attacks |= ((knights << 17) & NOT_A_FILE) | ((knights << 15) & NOT_H_FILE)
+             | ((knights >> 15) & NOT_A_FILE) | ((knights >> 17) & NOT_H_FILE)
+             | ((knights << 10) & NOT_AB_FILE) | ((knights << 6) & NOT_GH_FILE)
+             | ((knights >> 6) & NOT_AB_FILE) | ((knights >> 10) & NOT_GH_FILE);
+
+    uint64_t sliders = diagonal_sliders;
+    while (sliders) {
+        attacks |= attack_table_get_bishop_attacks(__builtin_ctzll(sliders), occupancy, attack_table);
+        sliders &= sliders - 1;
+    }
+    sliders = straight_sliders;
+    while (sliders) {
+        attacks |= attack_table_get_rook_attacks(__builtin_ctzll(sliders), occupancy, attack_table);
+        sliders &= sliders - 1;
+    }
+    *attacked_squares = attacks;
+
+    // Checkers are found by looking outwards from the king with each piece type's attack pattern.
+    if (!(attacks & king)) {
+        return 0ULL;
+    }
+
+    uint64_t pawn_attacks = SIDE_IS_WHITE ? attack_table->common->white_pawn_attack_table[king_index]
+                                          : attack_table->common->black_pawn_attack_table[king_index];
+
+    return (pawn_attacks & pawns)
+         | (attack_table->common->knight_table[king_index] & knights)
+         | (attack_table_get_bishop_attacks(king_index, occupancy, attack_table) & diagonal_sliders)
+         | (attack_table_get_rook_attacks(king_index, occupancy, attack_table) & straight_sliders);
+}
+
+static void SIDE_FN(get_check_info)(Board* board, const AttackTable* attack_table, CheckInfo* check_info) {
+    int king_index = __builtin_ctzll(board->bit_boards[FRIENDLY(WHITE_KING)]);
+    check_info->king_index = king_index;
+    check_info->king_attackers = SIDE_FN(get_attack_map)(board, king_index, attack_table, &check_info->attacked_squares);
+
+    // We assume the king doesn't have to be blocked, so all squares 'blocks' the king.
+    check_info->squares_blocking_king = ~0ULL;
+    uint64_t king_attackers = check_info->king_attackers;
+    if (king_attackers && !(king_attackers & (king_attackers - 1))) {
+        int attacker_index = __builtin_ctzll(king_attackers);
+        check_info->squares_blocking_king = attack_table->common->between[king_index][attacker_index] | (1ULL << attacker_index);
+    }
+
+    check_info->pinned_pieces = SIDE_FN(get_pinned_pieces)(board, king_index, attack_table);
+}
+
+static void SIDE_FN(generate_moves_from_squares)(Board* board,
+                                                 const AttackTable* attack_table,
+                                                 CheckInfo* check_info,
+                                                 MoveList* move_list,
+                                                 GenerationType type,
+                                                 uint64_t from_squares) {
+    FullMove* legal_moves = move_list->moves;
+    int* move_count = &move_list->count;
+    *move_count = 0;
+    legal_moves[0] = move_create(0, 0, 0);
+
+    int king_index = check_info->king_index;
+    uint64_t friendly_pieces = board->bit_boards[FRIENDLY_PIECES];
+    uint64_t enemy_pieces = board->bit_boards[ENEMY_PIECES];
+    uint64_t empty_squares = ~(friendly_pieces | enemy_pieces);
+    uint64_t target_squares;
+    uint64_t pawn_target_squares;
+
+    switch (type) {
+        case GENERATE_CAPTURES:
+            target_squares = enemy_pieces;
+            pawn_target_squares = enemy_pieces | PROMOTION_RANKS;
+            break;
+        case GENERATE_QUIETS:
+            target_squares = empty_squares;
+            pawn_target_squares = empty_squares & ~PROMOTION_RANKS;
+            break;
+        default:
+            target_squares = ~friendly_pieces;
+            pawn_target_squares = ~friendly_pieces;
+            break;
+    }
+
+    uint64_t legal_king_moves = 0ULL;
+    if (from_squares & (1ULL << king_index)) {
+        legal_king_moves = attack_table->common->king_table[king_index];
+        legal_king_moves &= target_squares;
+        legal_king_moves &= ~check_info->attacked_squares;
+    }
+
+    uint64_t king_attackers = check_info->king_attackers;
+    // King is double checked. Only king moves can be legal.
+    if (king_attackers & (king_attackers - 1)) {
+        get_moves_from_index(king_index, legal_king_moves, legal_moves, move_count, board);
+        return;
+    }
+
+    if (!king_attackers && type != GENERATE_CAPTURES && (from_squares & (1ULL << king_index))) {
+        SIDE_FN(add_castle_moves)(board, legal_moves, move_count, check_info->attacked_squares);
+    }
+
+    if (type != GENERATE_QUIETS) {
+        SIDE_FN(add_en_passant_moves)(board, attack_table, legal_moves, move_count, check_info, from_squares);
+    }
+
+    // Regular moves
+    SIDE_FN(add_pawn_moves)(board, attack_table, legal_moves, move_count, check_info, pawn_target_squares, from_squares);
+    SIDE_FN(get_moves_from_bit_board)(board, legal_moves, move_count, attack_table, check_info,
+                                      target_squares, from_squares);
+    get_moves_from_index(king_index, legal_king_moves, legal_moves, move_count, board);
+}
+
+static void SIDE_FN(add_en_passant_moves)(Board* board,
+                                          const AttackTable* attack_table,
+                                          FullMove* moves, int* move_count,
+                                          CheckInfo* check_info,
+                                          uint64_t from_squares) {
+    uint64_t pinned_pieces = check_info->pinned_pieces;
+    uint64_t squares_blocking_king = check_info->squares_blocking_king;
+    int king_index = check_info->king_index;
+
+    if (board->en_passant_index == -1) {
+        return;
+    }
+    if (board->en_passant_index / 8 != (SIDE_IS_WHITE ? 5 : 2)) {
+        return;
+    }
+
+    uint64_t pawns = board->bit_boards[FRIENDLY(WHITE_PAWN)] & from_squares;
+    const uint64_t* pawn_attack_table = SIDE_IS_WHITE ? attack_table->common->white_pawn_attack_table : attack_table->common->black_pawn_attack_table;
+    int captured_index = board->en_passant_index - PAWN_PUSH;
+
+    if (squares_blocking_king & (1ULL << captured_index)) {
+        squares_blocking_king |= 1ULL << (board->en_passant_index);
+    }
+
+    while (pawns) {
+        int from_index = __builtin_ctzll(pawns);
+        pawns &= pawns - 1;
+
+        uint64_t current_attacks = pawn_attack_table[from_index];
+        uint64_t legal_move = current_attacks & (1ULL << (board->en_passant_index));
+        legal_move &= squares_blocking_king;
+
+        if (pinned_pieces & (1ULL << from_index)) {
+            legal_move &= attack_table->common->line[king_index][from_index];
+        }
+
+        if (legal_move) {
+            if (SIDE_FN(check_en_passant_legality)(board, attack_table, king_index, from_index, board->en_passant_index)) {
+                Move en_passant_move = move_create(from_index, board->en_passant_index, EN_PASSANT_FLAG);
+                moves[(*move_count)++] = full_move_create(en_passant_move, FRIENDLY(WHITE_PAWN), ENEMY(WHITE_PAWN));
+            }
+        }
+    }
+}
+
+/*
+ * Checks the edge-cases where removing the captured pawn exposes the king: the two pawns
+ * "double-pinned" on the king's rank, or the captured pawn blocking a diagonal. The capture
+ * is illegal if a matching enemy slider on the line through the king and the captured pawn
+ * has nothing left between it and the king.
+ */
+static bool SIDE_FN(check_en_passant_legality)(Board* board, const AttackTable* attack_table, int king_index, int from_index, int to_index) {
+    int captured_index = to_index - PAWN_PUSH;
+    bool straight = king_index / 8 == captured_index / 8 || king_index % 8 == captured_index % 8;
+
+    uint64_t sliders = board->bit_boards[straight ? ENEMY(WHITE_ROOK) : ENEMY(WHITE_BISHOP)] |
+                       board->bit_boards[ENEMY(WHITE_QUEEN)];
+    sliders &= attack_table->common->line[king_index][captured_index];
+    if (!sliders) {
+        return true;
+    }
+
+    uint64_t all_pieces = board->bit_boards[WHITE_PIECES] | board->bit_boards[BLACK_PIECES];
+    all_pieces &= ~((1ULL << from_index) | (1ULL << captured_index));
+    all_pieces |= 1ULL << to_index;
+
+    while (sliders) {
+        int slider_index = __builtin_ctzll(sliders);
+        sliders &= sliders - 1;
+
+        if (!(attack_table->common->between[king_index][slider_index] & all_pieces)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void SIDE_FN(add_castle_moves)(Board* board, FullMove* legal_moves, int* move_count, uint64_t attacked_squares) {
+    uint64_t all_pieces = board->bit_boards[BLACK_PIECES] | board->bit_boards[WHITE_PIECES];
+    if (SIDE_IS_WHITE) {
+        if (board_white_can_castle_king(board) && !(attacked_squares & WHITE_KINGSIDE_CASTLE_SAFE)
+            && !(WHITE_KINGSIDE_CASTLE_SAFE & all_pieces)) {
+            legal_moves[(*move_count)++] = full_move_create(move_create(4, 6, CASTLE_FLAG), WHITE_KING, -1);
+        }
+
+        if (board_white_can_castle_queen(board) && !(attacked_squares & WHITE_QUEENSIDE_CASTLE_SAFE)
+            && !(WHITE_QUEENSIDE_CASTLE_SAFE & all_pieces)) {
+
+            if (!((1ULL << 1) & all_pieces)) {
+                legal_moves[(*move_count)++] = full_move_create(move_create(4, 2, CASTLE_FLAG), WHITE_KING, -1);
+            }
+        }
+    }
+    else {
+        if (board_black_can_castle_king(board) && !(attacked_squares & BLACK_KINGSIDE_CASTLE_SAFE)
+            && !(BLACK_KINGSIDE_CASTLE_SAFE & all_pieces)) {
+            legal_moves[(*move_count)++] = full_move_create(move_create(60, 62, CASTLE_FLAG), BLACK_KING, -1);
+        }
+
+        if (board_black_can_castle_queen(board) && !(attacked_squares & BLACK_QUEENSIDE_CASTLE_SAFE)
+            && !(BLACK_QUEENSIDE_CASTLE_SAFE & all_pieces)) {
+
+            if (!((1ULL << 57) & all_pieces)) {
+                legal_moves[(*move_count)++] = full_move_create(move_create(60, 58, CASTLE_FLAG), BLACK_KING, -1);
+            }
+        }
+    }
+}
+
+/*
+ * Gets real legal moves for knights and sliders. Each piece type is its own loop, so there
+ * is no per-piece switch on the type.
+ */
+static void SIDE_FN(get_moves_from_bit_board)(Board* board,
+                                              FullMove* moves,
+                                              int* current_index,
+                                              const AttackTable* attack_table,
+                                              CheckInfo* check_info,
+                                              uint64_t target_squares,
+                                              uint64_t from_squares) {
+    uint64_t occupancy = board->bit_boards[WHITE_PIECES] | board->bit_boards[BLACK_PIECES];
+    uint64_t queens = board->bit_boards[FRIENDLY(WHITE_QUEEN)] & from_squares;
+    uint64_t piece_sets[3] = {
+        board->bit_boards[FRIENDLY(WHITE_KNIGHT)] & from_squares,
+        (board->bit_boards[FRIENDLY(WHITE_BISHOP)] & from_squares) | queens,
+        (board->bit_boards[FRIENDLY(WHITE_ROOK)] & from_squares) | queens,
+    };
+
+    // Queens get their diagonal and straight moves added separately.
+    for (int set = 0 ; set < 3 ; set++) {
+        uint64_t current_pieces = piece_sets[set];
+        while (current_pieces) {
+            int from_index = __builtin_ctzll(current_pieces);
+            current_pieces &= current_pieces - 1;
+
+            uint64_t current_attacks;
+            switch (set) {
+                case 0:
+                    current_attacks = attack_table->common->knight_table[from_index];
+                    break;
+                case 1:
+                    current_attacks = attack_table_get_bishop_attacks(from_index, occupancy, attack_table);
+                    break;
+                default:
+                    current_attacks = attack_table_get_rook_attacks(from_index, occupancy, attack_table);
+                    break;
+            }
+
+            current_attacks &= target_squares & check_info->squares_blocking_king;
+            if (check_info->pinned_pieces & (1ULL << from_index)) {
+                current_attacks &= attack_table->common->line[check_info->king_index][from_index];
+            }
+            get_moves_from_index(from_index, current_attacks, moves, current_index, board);
+        }
+    }
+}
+
+/*
+ * Pawn moves for all pawns at once. Unpinned pawns are shifted as one set, pinned pawns one at
+ * a time since each has its own pin line. En passant is added by add_en_passant_moves.
+ */
+static void SIDE_FN(add_pawn_moves)(Board* board,
+                                    const AttackTable* attack_table,
+                                    FullMove* moves,
+                                    int* move_count,
+                                    CheckInfo* check_info,
+                                    uint64_t pawn_target_squares,
+                                    uint64_t from_squares) {
+    uint64_t pawns = board->bit_boards[FRIENDLY(WHITE_PAWN)] & from_squares;
+    uint64_t target_squares = pawn_target_squares & check_info->squares_blocking_king;
+    uint64_t pinned_pawns = pawns & check_info->pinned_pieces;
+
+    SIDE_FN(add_pawn_set_moves)(board, moves, move_count, pawns & ~pinned_pawns, target_squares);
+
+    while (pinned_pawns) {
+        int from_index = __builtin_ctzll(pinned_pawns);
+        pinned_pawns &= pinned_pawns - 1;
+
+        uint64_t pin_line = attack_table->common->line[check_info->king_index][from_index];
+        SIDE_FN(add_pawn_set_moves)(board, moves, move_count, 1ULL << from_index, target_squares & pin_line);
+    }
+
+    moves[*move_count] = move_create(0, 0, 0);
+}
+
+/*
+ * Every kind of pawn move is a single shift of the pawn set, so the flag follows from the shift
+ * and the from square is the target shifted back.
+ */
+static void SIDE_FN(add_pawn_set_moves)(Board* board, FullMove* moves, int* move_count, uint64_t pawns, uint64_t target_squares) {
+    uint64_t empty_squares = ~(board->bit_boards[WHITE_PIECES] | board->bit_boards[BLACK_PIECES]);
+    uint64_t enemy_pieces = board->bit_boards[ENEMY_PIECES];
+
+    uint64_t single_pushes = shift_bit_board(pawns, PAWN_PUSH) & empty_squares;
+    uint64_t double_pushes = shift_bit_board(single_pushes & (SIDE_IS_WHITE ? RANK_3 : RANK_6), PAWN_PUSH) & empty_squares;
+    uint64_t left_captures = shift_bit_board(pawns & NOT_A_FILE, PAWN_PUSH - 1) & enemy_pieces;
+    uint64_t right_captures = shift_bit_board(pawns & NOT_H_FILE, PAWN_PUSH + 1) & enemy_pieces;
+
+    single_pushes &= target_squares;
+    double_pushes &= target_squares;
+    left_captures &= target_squares;
+    right_captures &= target_squares;
+
+    add_promotions_with_offset(moves, move_count, board, left_captures & PROMOTION_RANKS, PAWN_PUSH - 1);
+    add_promotions_with_offset(moves, move_count, board, right_captures & PROMOTION_RANKS, PAWN_PUSH + 1);
+    add_promotions_with_offset(moves, move_count, board, single_pushes & PROMOTION_RANKS, PAWN_PUSH);
+
+    add_moves_with_offset(moves, move_count, board, left_captures & ~PROMOTION_RANKS, PAWN_PUSH - 1, NORMAL_MOVE_FLAG);
+    add_moves_with_offset(moves, move_count, board, right_captures & ~PROMOTION_RANKS, PAWN_PUSH + 1, NORMAL_MOVE_FLAG);
+    add_moves_with_offset(moves, move_count, board, single_pushes & ~PROMOTION_RANKS, PAWN_PUSH, NORMAL_MOVE_FLAG);
+    add_moves_with_offset(moves, move_count, board, double_pushes, 2 * PAWN_PUSH, EN_PASSANT_AVAILABLE_FLAG);
+}
+
+/*
+ * Enemy sliders that would attack the king if only enemy pieces could block are the possible
+ * pinners. A friendly piece is pinned if it is the only piece between such a slider and the king.
+ */
+static uint64_t SIDE_FN(get_pinned_pieces)(Board* board, int king_index, const AttackTable* attack_table) {
+    uint64_t friendly_pieces = board->bit_boards[FRIENDLY_PIECES];
+    uint64_t enemy_pieces = board->bit_boards[ENEMY_PIECES];
+    uint64_t queens = board->bit_boards[ENEMY(WHITE_QUEEN)];
+
+    uint64_t pinners = (attack_table_get_rook_attacks(king_index, enemy_pieces, attack_table) &
+                        (board->bit_boards[ENEMY(WHITE_ROOK)] | queens))
+                     | (attack_table_get_bishop_attacks(king_index, enemy_pieces, attack_table) &
+                        (board->bit_boards[ENEMY(WHITE_BISHOP)] | queens));
+
+    uint64_t pinned_pieces = 0ULL;
+    while (pinners) {
+        int pinner_index = __builtin_ctzll(pinners);
+        pinners &= pinners - 1;
+
+        uint64_t blockers = attack_table->common->between[king_index][pinner_index] & friendly_pieces;
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned_pieces |= blockers;
+        }
+    }
+
+    return pinned_pieces;
+}
+
+#undef FRIENDLY
+#undef ENEMY
+#undef FRIENDLY_PIECES
+#undef ENEMY_PIECES
+#undef PAWN_PUSH
@@ -0,0 +1,176 @@
+#include "movepicker.h"
+#include "evaluate.h"
+
+// Pushes bad captures below every good capture.
+#define BAD_CAPTURE_PENALTY 100000
+
+void score_captures(MovePicker* picker);
+int get_capture_score(MovePicker* picker, FullMove move);
+FullMove pick_best_capture(MovePicker* picker);
+bool is_killer(MovePicker* picker, Move move);
+
+/* -------------------------- External functions ----------------------------*/
+
+void move_picker_init(MovePicker* picker, 
+                      Board* board, 
+                      const AttackTable* attack_table, 
+                      CheckInfo* check_info, 
+                      Move hash_move, 
+                      Move* killers) {
+    picker->board = board;
+    picker->attack_table = attack_table;
+    picker->check_info = *check_info;
+    picker->stage = PICK_HASH_MOVE;
+    picker->hash_move = hash_move;
+    picker->killer_index = 0;
+    picker->capture_index = 0;
+    picker->quiet_index = 0;
+
+    for (int i = 0 ; i < KILLER_COUNT ; i++) {
+        picker->killers[i] = killers[i];
+    }
+}
+
+FullMove move_picker_next(MovePicker* picker) {
+    FullMove move;
+
+    switch (picker->stage) {
+        case PICK_HASH_MOVE:
+            picker->stage = PICK_GENERATE_CAPTURES;
+            move = get_legal_full_move(picker->board, picker->attack_table, &picker->check_info, picker->hash_move, GENERATE_ALL);
+            if (move_exists(full_move_get_move(move))) {
+                return move;
+            }
+            // Fall through
+
+        case PICK_GENERATE_CAPTURES:
+            generate_moves_from_squares(picker->board, picker->attack_table, &picker->check_info, 
+                                        &picker->captures, GENERATE_CAPTURES, ~0ULL);
+            score_captures(picker);
+            picker->stage = PICK_GOOD_CAPTURES;
+            // Fall through
+
+        case PICK_GOOD_CAPTURES:
+            while (picker->capture_index < picker->captures.count) {
+                move = pick_best_capture(picker);
+                if (picker->capture_scores[picker->capture_index] < 0) {
+                    break;
+                }
+                picker->capture_index++;
+                if (full_move_get_move(move) != picker->hash_move) {
+                    return move;
+                }
+            }
+            picker->stage = PICK_KILLERS;
+            // Fall through
+
+        case PICK_KILLERS:
+            while (picker->killer_index < KILLER_COUNT) {
+                Move killer = picker->killers[picker->killer_index++];
+                if (killer == picker->hash_move) {
+                    continue;
+                }
+                move = get_legal_full_move(picker->board, picker->attack_table, &picker->check_info, killer, GENERATE_QUIETS);
+                if (move_exists(full_move_get_move(move))) {
+                    return move;
+                }
+            }
+            picker->stage = PICK_GENERATE_QUIETS;
+            // Fall through
+
+        case PICK_GENERATE_QUIETS:
+            generate_moves_from_squares(picker->board, picker->attack_table, &picker->check_info, 
+                                        &picker->quiets, GENERATE_QUIETS, ~0ULL);
+            picker->stage = PICK_QUIETS;
+            // Fall through
+
+        case PICK_QUIETS:
+            while (picker->quiet_index < picker->quiets.count) {
+                move = picker->quiets.moves[picker->quiet_index++];
+                if (full_move_get_move(move) != picker->hash_move && !is_killer(picker, full_move_get_move(move))) {
+                    return move;
+                }
+            }
+            picker->stage = PICK_BAD_CAPTURES;
+            // Fall through
+
+        case PICK_BAD_CAPTURES:
+            while (picker->capture_index < picker->captures.count) {
+                move = pick_best_capture(picker);
+                picker->capture_index++;
+                if (full_move_get_move(move) != picker->hash_move) {
+                    return move;
+                }
+            }
+            picker->stage = PICK_DONE;
+            // Fall through
+
+        default:
+            return move_create(0, 0, 0);
+    }
+}
+
+/* -------------------------- Internal functions ----------------------------*/
+
+void score_captures(MovePicker* picker) {
+    for (int i = 0 ; i < picker->captures.count ; i++) {
+        picker->capture_scores[i] = get_capture_score(picker, picker->captures.moves[i]);
+    }
+}
+
+/*
+ * MVV-LVA. A capture is good if it doesn't lose material even when the victim is defended,
+ * or if the victim isn't defended at all. Under-promotions are always tried last.
+ */
+int get_capture_score(MovePicker* picker, FullMove move) {
+    Board* board = picker->board;
+    int to_index = move_get_to_index(move);
+    MoveFlag flag = move_get_flag(move);
+    int pawn_value = get_piece_value(WHITE_PAWN, board);
+
+    int attacker_value = get_piece_value(full_move_get_piece(move), board);
+    int victim_value = get_piece_value(full_move_get_captured_piece(move), board);
+
+    if (flag == QUEEN_PROMOTION_FLAG) {
+        victim_value += get_piece_value(WHITE_QUEEN, board) - pawn_value;
+    }
+
+    int score = victim_value * 10 - attacker_value;
+    bool is_under_promotion = flag == ROOK_PROMOTION_FLAG || flag == BISHOP_PROMOTION_FLAG || flag == KNIGHT_PROMOTION_FLAG;
+    bool is_defended = picker->check_info.attacked_squares & (1ULL << to_index);
+
+    if (is_under_promotion || (victim_value < attacker_value && is_defended)) {
+        return score - BAD_CAPTURE_PENALTY;
+    }
+
+    return score;
+}
+
+/* Selection sort step: swaps the best remaining capture to capture_index and returns it. */
+FullMove pick_best_capture(MovePicker* picker) {
+    int best_index = picker->capture_index;
+    for (int i = picker->capture_index + 1 ; i < picker->captures.count ; i++) {
+        if (picker->capture_scores[i] > picker->capture_scores[best_index]) {
+            best_index = i;
+        }
+    }
+
+    FullMove best_move = picker->captures.moves[best_index];
+    int best_score = picker->capture_scores[best_index];
+    picker->captures.moves[best_index] = picker->captures.moves[picker->capture_index];
+    picker->capture_scores[best_index] = picker->capture_scores[picker->capture_index];
+    picker->captures.moves[picker->capture_index] = best_move;
+    picker->capture_scores[picker->capture_index] = best_score;
+
+    return best_move;
+}
+
+bool is_killer(MovePicker* picker, Move move) {
+    for (int i = 0 ; i < KILLER_COUNT ; i++) {
+        if (picker->killers[i] == move) {
+            return true;
+        }
+    }
+
+    return false;
+}
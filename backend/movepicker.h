@@ -0,0 +1,63 @@
+/**
+ * @brief   Staged move picker for the main search.
+ *
+ *          Moves are handed out in phases: hash move, good captures, killers,
+ *          quiet moves and finally bad captures. Each phase is only generated
+ *          once the previous one is exhausted, so a cutoff on an early move
+ *          skips most of the generation and sorting.
+ *
+ * @file    movepicker.h
+ */
+
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "board.h"
+#include "movegenerator.h"
+
+#define KILLER_COUNT 2
+
+typedef enum {
+    PICK_HASH_MOVE,
+    PICK_GENERATE_CAPTURES,
+    PICK_GOOD_CAPTURES,
+    PICK_KILLERS,
+    PICK_GENERATE_QUIETS,
+    PICK_QUIETS,
+    PICK_BAD_CAPTURES,
+    PICK_DONE,
+} PickStage;
+
+typedef struct {
+    Board* board;
+    const AttackTable* attack_table;
+    CheckInfo check_info;
+    PickStage stage;
+    Move hash_move;
+    Move killers[KILLER_COUNT];
+    int killer_index;
+    MoveList captures;
+    int capture_scores[MAX_LEGAL_MOVES];
+    int capture_index;
+    MoveList quiets;
+    int quiet_index;
+} MovePicker;
+
+/**
+ * @brief Prepares the picker for the side to move. Nothing is generated yet.
+ * 
+ * @param check_info    Check info for the current position, shared with the caller.
+ * @param hash_move     Tried first if it is legal. May be a non-existing move.
+ * @param killers       KILLER_COUNT killer moves for the current ply.
+ */
+void move_picker_init(MovePicker* picker, 
+                      Board* board, 
+                      const AttackTable* attack_table, 
+                      CheckInfo* check_info, 
+                      Move hash_move, 
+                      Move* killers);
+
+// Returns the next legal move, or a non-existing move when all moves have been picked.
+FullMove move_picker_next(MovePicker* picker);
+
+#endif
@@ -19,12 +19,12 @@ typedef struct {
     int guess_score;
 } ScoredMove;
 
-int min_max(Board* board, AttackTable* attack_table, int depth);
-int alpha_beta(Board* board, AttackTable* attack_table, int alpha, int beta, int depth);
-int alpha_beta_ordered(Board* board, AttackTable* attack_table, int alpha, int beta, int depth);
-ScoredMove* iterative_deepening(Board* board, AttackTable* attack_table, double time);
+int min_max(Board* board, const AttackTable* attack_table, int depth);
+int alpha_beta(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth);
+int alpha_beta_ordered(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth);
+ScoredMove* iterative_deepening(Board* board, const AttackTable* attack_table, double time);
 
-int search_captures_only(Board* board, AttackTable* attack_table, int alpha, int beta, int depth);
+int search_captures_only(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth);
 
 // Move ordering
 ScoredMove* get_scored_moves(Board* board, Move* moves, int move_count);
@@ -35,7 +35,7 @@ void order_moves_by_eval(Board* board, ScoredMove* scored_moves, int move_count)
 void print_search_stats();
 
 
-Move search_best_move(Board* board, AttackTable* attack_table, int depth, SearchAlg alg) {
+Move search_best_move(Board* board, const AttackTable* attack_table, int depth, SearchAlg alg) {
     clock_t start_time = clock();
     positions_searched = 0;
     best_move_found = move_create(0, 0, 0);
@@ -107,7 +107,7 @@ Move search_best_move(Board* board, AttackTable* attack_table, int depth, Search
 }
 
 
-ScoredMove* iterative_deepening(Board* board, AttackTable* attack_table, double time) {
+ScoredMove* iterative_deepening(Board* board, const AttackTable* attack_table, double time) {
     int max_depth = 3;
     int current_depth = 1;
     int move_count = 0;
@@ -142,7 +142,7 @@ ScoredMove* iterative_deepening(Board* board, AttackTable* attack_table, double
 }
 
 
-int alpha_beta_ordered(Board* board, AttackTable* attack_table, int alpha, int beta, int depth) {
+int alpha_beta_ordered(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth) {
     /*if (depth == 0) {
         if (board->turn) {
             return board_evaluate_current(board);
@@ -192,7 +192,7 @@ int alpha_beta_ordered(Board* board, AttackTable* attack_table, int alpha, int b
 
 // Alpha = The minimum score of the current player
 // Beta = The maximum score the opponent is willing to tolerate
-int alpha_beta(Board* board, AttackTable* attack_table, int alpha, int beta, int depth) {
+int alpha_beta(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth) {
     /*if (depth == 0) {
         if (board->turn) {
             return board_evaluate_current(board);
@@ -235,7 +235,7 @@ int alpha_beta(Board* board, AttackTable* attack_table, int alpha, int beta, int
 
 
 // Returns the evaluation for the best move according to the current player
-int min_max(Board* board, AttackTable* attack_table, int depth) {
+int min_max(Board* board, const AttackTable* attack_table, int depth) {
     if (depth == 0) {
         if (board->turn) {
             return board_evaluate_current(board);
@@ -273,7 +273,7 @@ int min_max(Board* board, AttackTable* attack_table, int depth) {
     return best_score;
 }
 
-int search_captures_only(Board* board, AttackTable* attack_table, int alpha, int beta, int depth) {
+int search_captures_only(Board* board, const AttackTable* attack_table, int alpha, int beta, int depth) {
     positions_searched++;
     int score = board_evaluate_current(board);
     score = board->turn ? score : -score;
@@ -0,0 +1,290 @@
+#include "perft.h"
+#include "movegenerator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "transpositiointable.h"
+
+#define PERFT_MAX_SPLIT_DEPTH 8
+
+// Move sequences from the root that are searched as independent tasks, paths[i * split_depth] onwards.
+typedef struct {
+    FullMove* paths;
+    uint64_t* nodes;
+    int count;
+    int capacity;
+    int split_depth;
+} TaskList;
+
+typedef struct {
+    Board* board;
+    const AttackTable* attack_table;
+    TaskList* tasks;
+    PerftTable* table;
+    int depth;
+    int next_task;
+    pthread_mutex_t lock;
+} WorkerShared;
+
+static void add_tasks(Board* board, const AttackTable* attack_table, TaskList* tasks, FullMove* path, int ply);
+static void* perft_worker(void* arg);
+
+/* -------------------------- External functions ----------------------------*/
+
+uint64_t perft(Board* board, const AttackTable* attack_table, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    uint64_t attacked_squares = 0ULL;
+    MoveList moves;
+    generate_legal_moves(board, attack_table, &moves, &attacked_squares);
+
+    if (depth == 1) {
+        return moves.count;
+    }
+
+    uint64_t nodes = 0;
+    Position saved;
+    for (int i = 0 ; i < moves.count ; i++) {
+        board_make(moves.moves[i], board, &saved);
+        nodes += perft(board, attack_table, depth - 1);
+        board_unmake(moves.moves[i], board, &saved);
+    }
+
+    return nodes;
+}
+
+uint64_t perft_divide(Board* board, const AttackTable* attack_table, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    uint64_t attacked_squares = 0ULL;
+    MoveList moves;
+    generate_legal_moves(board, attack_table, &moves, &attacked_squares);
+
+    uint64_t nodes = 0;
+    char move_string[MOVE_STRING_SIZE];
+    Position saved;
+    for (int i = 0 ; i < moves.count ; i++) {
+        board_make(moves.moves[i], board, &saved);
+        uint64_t move_nodes = perft(board, attack_table, depth - 1);
+        board_unmake(moves.moves[i], board, &saved);
+
+        move_to_string(full_move_get_move(moves.moves[i]), move_string);
+        printf("%s: %" PRIu64 "\n", move_string, move_nodes);
+        nodes += move_nodes;
+    }
+    printf("\n");
+
+    return nodes;
+}
+
+PerftTable* perft_table_create(int size_MB) {
+    PerftTable* table = malloc(sizeof(PerftTable));
+    if (!table) {
+        return NULL;
+    }
+
+    table->capacity = tt_get_capacity(size_MB, sizeof(PerftEntry));
+    table->entries = calloc(table->capacity, sizeof(PerftEntry));
+    if (!table->entries) {
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void perft_table_destroy(PerftTable* table) {
+    free(table->entries);
+    free(table);
+}
+
+uint64_t perft_hashed(Board* board, const AttackTable* attack_table, PerftTable* table, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    uint64_t attacked_squares = 0ULL;
+    MoveList moves;
+    generate_legal_moves(board, attack_table, &moves, &attacked_squares);
+
+    if (depth == 1) {
+        return moves.count;
+    }
+
+    uint64_t zobrist_key = board_get_zobrist_hash(board);
+    PerftEntry* entry = &table->entries[zobrist_key & (table->capacity - 1)];
+    // Shared by the perft_parallel workers, a torn entry fails the key check like in the TT.
+    uint64_t data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+    uint64_t key = __atomic_load_n(&entry->key, __ATOMIC_RELAXED);
+    if ((key ^ data) == zobrist_key && (int)(data & 0xFF) == depth) {
+        return data >> 8;
+    }
+
+    uint64_t nodes = 0;
+    Position saved;
+    for (int i = 0 ; i < moves.count ; i++) {
+        board_make(moves.moves[i], board, &saved);
+        nodes += perft_hashed(board, attack_table, table, depth - 1);
+        board_unmake(moves.moves[i], board, &saved);
+    }
+
+    data = (nodes << 8) | depth;
+    __atomic_store_n(&entry->key, zobrist_key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->data, data, __ATOMIC_RELAXED);
+
+    return nodes;
+}
+
+uint64_t perft_parallel(Board* board, 
+                        const AttackTable* attack_table, 
+                        PerftTable* table, 
+                        int depth, 
+                        int split_depth, 
+                        int thread_count, 
+                        bool divide) {
+    if (split_depth > depth - 1) {
+        split_depth = depth - 1;
+    }
+    if (split_depth > PERFT_MAX_SPLIT_DEPTH) {
+        split_depth = PERFT_MAX_SPLIT_DEPTH;
+    }
+    if (split_depth < 1) {
+        return divide ? perft_divide(board, attack_table, depth) : perft(board, attack_table, depth);
+    }
+
+    TaskList tasks = {
+        .split_depth = split_depth,
+    };
+    FullMove path[PERFT_MAX_SPLIT_DEPTH];
+    add_tasks(board, attack_table, &tasks, path, 0);
+
+    WorkerShared shared = {
+        .board = board,
+        .attack_table = attack_table,
+        .tasks = &tasks,
+        .table = table,
+        .depth = depth - split_depth,
+        .next_task = 0,
+    };
+    pthread_mutex_init(&shared.lock, NULL);
+
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+    pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+    int started_count = 0;
+    while (started_count < thread_count && pthread_create(&threads[started_count], NULL, perft_worker, &shared) == 0) {
+        started_count++;
+    }
+    // The workers take tasks until there are none left, so fewer of them still finish the count.
+    if (started_count == 0) {
+        perft_worker(&shared);
+    }
+    for (int i = 0 ; i < started_count ; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&shared.lock);
+
+    // Tasks are stored in move generation order, so the sum and the divide output are deterministic.
+    uint64_t nodes = 0;
+    uint64_t root_nodes = 0;
+    char move_string[MOVE_STRING_SIZE];
+    for (int i = 0 ; i < tasks.count ; i++) {
+        nodes += tasks.nodes[i];
+        root_nodes += tasks.nodes[i];
+
+        FullMove root_move = tasks.paths[i * split_depth];
+        bool last_of_root = i == tasks.count - 1 || tasks.paths[(i + 1) * split_depth] != root_move;
+        if (divide && last_of_root) {
+            move_to_string(full_move_get_move(root_move), move_string);
+            printf("%s: %" PRIu64 "\n", move_string, root_nodes);
+        }
+        if (last_of_root) {
+            root_nodes = 0;
+        }
+    }
+    if (divide) {
+        printf("\n");
+    }
+
+    free(tasks.paths);
+    free(tasks.nodes);
+    return nodes;
+}
+
+/* -------------------------- Internal functions ----------------------------*/
+
+/*
+ * Collects every legal move sequence of length split_depth. A sequence that ends early in mate
+ * or stalemate has no leaves and is dropped.
+ */
+static void add_tasks(Board* board, const AttackTable* attack_table, TaskList* tasks, FullMove* path, int ply) {
+    if (ply == tasks->split_depth) {
+        if (tasks->count == tasks->capacity) {
+            tasks->capacity = tasks->capacity ? tasks->capacity * 2 : 256;
+            tasks->paths = realloc(tasks->paths, tasks->capacity * tasks->split_depth * sizeof(FullMove));
+            tasks->nodes = realloc(tasks->nodes, tasks->capacity * sizeof(uint64_t));
+        }
+        memcpy(&tasks->paths[tasks->count * tasks->split_depth], path, tasks->split_depth * sizeof(FullMove));
+        tasks->nodes[tasks->count++] = 0;
+        return;
+    }
+
+    uint64_t attacked_squares = 0ULL;
+    MoveList moves;
+    generate_legal_moves(board, attack_table, &moves, &attacked_squares);
+
+    for (int i = 0 ; i < moves.count ; i++) {
+        path[ply] = moves.moves[i];
+        board_push_full_move(moves.moves[i], board);
+        board_change_turn(board);
+        add_tasks(board, attack_table, tasks, path, ply + 1);
+        board_pop_move(board);
+        board_change_turn(board);
+    }
+}
+
+static void* perft_worker(void* arg) {
+    WorkerShared* shared = arg;
+    TaskList* tasks = shared->tasks;
+    Board* board = board_copy(shared->board);
+
+    while (true) {
+        pthread_mutex_lock(&shared->lock);
+        int task = shared->next_task++;
+        pthread_mutex_unlock(&shared->lock);
+
+        if (task >= tasks->count) {
+            break;
+        }
+
+        FullMove* path = &tasks->paths[task * tasks->split_depth];
+        for (int i = 0 ; i < tasks->split_depth ; i++) {
+            board_push_full_move(path[i], board);
+            board_change_turn(board);
+        }
+
+        // Each task owns its slot, so no locking is needed for the result.
+        if (shared->table) {
+            tasks->nodes[task] = perft_hashed(board, shared->attack_table, shared->table, shared->depth);
+        }
+        else {
+            tasks->nodes[task] = perft(board, shared->attack_table, shared->depth);
+        }
+
+        for (int i = 0 ; i < tasks->split_depth ; i++) {
+            board_pop_move(board);
+            board_change_turn(board);
+        }
+    }
+
+    board_destroy(board);
+    return NULL;
+}
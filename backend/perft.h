@@ -0,0 +1,66 @@
+/**
+ * @brief   Perft: counts the leaf nodes of the legal move tree to a fixed depth.
+ *
+ *          Used both to validate move generation against known counts and to
+ *          measure its throughput.
+ *
+ * @file    perft.h
+ */
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "board.h"
+#include "attacktable.h"
+
+/**
+ * @brief Counts the leaf nodes at the given depth. At depth 1 the number of legal moves is
+ *        returned directly instead of making each move (bulk counting).
+ */
+uint64_t perft(Board* board, const AttackTable* attack_table, int depth);
+
+// Like perft, but also prints the node count below each root move.
+uint64_t perft_divide(Board* board, const AttackTable* attack_table, int depth);
+
+/*
+ * Caches node counts by (zobrist key, depth). The key is stored XORed with the data, so an entry
+ * torn by two threads writing at once fails verification instead of returning a wrong count.
+ */
+typedef struct {
+    uint64_t key;
+    uint64_t data;      // Node count << 8 | depth
+} PerftEntry;
+
+typedef struct {
+    PerftEntry* entries;
+    size_t capacity;
+} PerftTable;
+
+// Returns NULL if the table can't be allocated.
+PerftTable* perft_table_create(int size_MB);
+
+void perft_table_destroy(PerftTable* table);
+
+// Perft that looks up and stores the count of every subtree of depth 2 or more in the table.
+uint64_t perft_hashed(Board* board, const AttackTable* attack_table, PerftTable* table, int depth);
+
+/**
+ * @brief Perft on several threads. Every move sequence of length split_depth becomes a task, and
+ *        the tasks are shared between the threads. Each thread works on its own copy of the board,
+ *        the attack table is shared. The result doesn't depend on the thread count.
+ * 
+ * @param split_depth   Depth of the tasks, 1 splits at the root. Clamped to depth - 1.
+ * @param table         Perft table shared by all threads, or NULL to not use one.
+ * @param divide        Print the node count below each root move, like perft_divide.
+ */
+uint64_t perft_parallel(Board* board, 
+                        const AttackTable* attack_table, 
+                        PerftTable* table, 
+                        int depth, 
+                        int split_depth, 
+                        int thread_count, 
+                        bool divide);
+
+#endif
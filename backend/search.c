@@ -1,24 +1,53 @@
+// For clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
 #include "search.h"
 #include "evaluate.h"
 #include "bitboard.h"
 #include "movegenerator.h"
+#include "movepicker.h"
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <pthread.h>
 
-#define LARGE_POSITIVE 100000
-#define LARGE_NEGATIVE -100000
+// Scores are stored in 16 bits in the transposition table.
+#define LARGE_POSITIVE 30000
+#define LARGE_NEGATIVE -30000
 
 typedef struct {
-    Move move;
+    FullMove move;
     int eval_score;
     int guess_score;
 } ScoredMove;
 
+#define MAX_DEPTH 50
+#define MAX_THREADS 256
+
+/*
+ * Everything one search thread owns. With Lazy SMP every thread searches the same root on its
+ * own board and only the transposition table is shared, the counters are summed afterwards.
+ */
 typedef struct {
     Board* board;
-    AttackTable* attack_table;
+    Move killer_moves[MAX_DEPTH][KILLER_COUNT];
+    int positions_searched;
+    int quiescence_searched;
+    int tt_hits;
+    int tt_pruning_hits;
+    int tt_lookups;
+    int delta_prunes;
+    int index;              // 0 is the main thread
+    int depth;
+    const AttackTable* attack_table;
     TTable* t_table;
+} SearchThread;
+
+typedef struct {
+    Board* board;
+    const AttackTable* attack_table;
+    TTable* t_table;
+    SearchThread* thread;
     int alpha;
     int beta;
     int depth;
@@ -26,6 +55,10 @@ typedef struct {
     Move* best_move;
 } SearchParams;
 
+static int thread_count = 1;
+// Set when the main thread is done, the helper threads then abandon their search.
+static int stop_search = 0;
+
 static int positions_searched = 0;
 static int quiescence_searched = 0;
 static double elapsed_time = -1;
@@ -40,103 +73,196 @@ static int delta_prunes = 0;
 
 // Main search
 int alpha_beta(SearchParams params, int alpha, int beta, int depth, int ply, Move* best_move);
-int search_captures_only(Board* board, AttackTable* attack_table, TTable* t_table, int alpha, int beta, int depth);
-Move iterative_deepening(Board* board, AttackTable* attack_table, int depth);
+int search_captures_only(SearchParams params, int alpha, int beta, int depth);
+Move iterative_deepening(Board* board, const AttackTable* attack_table, TTable* t_table, int depth);
+void search_thread_init(SearchThread* thread, int index, Board* board, const AttackTable* attack_table, TTable* t_table, int depth);
+void* search_helper(void* arg);
+static inline bool search_stopped(SearchThread* thread);
 
 // Move ordering
-ScoredMove* get_scored_moves(Board* board, Move* moves, int move_count, int depth);
-int get_move_score(Board* board, Move move, int depth);
+void get_scored_moves(Board* board, MoveList* move_list, ScoredMove* scored_moves, Move* killers);
+int get_move_score(Board* board, FullMove move, Move* killers);
 void order_moves_by_guess(Board* board, ScoredMove* scored_moves, int move_count, Move* best_move);
 void order_moves_by_eval(Board* board, ScoredMove* scored_moves, int move_count);
 int compare_guess_scores(const void* m1, const void* m2);
 int compare_evals(const void* m1, const void* m2);
-void store_killer(int ply, Move move);
-bool move_is_killer(int ply, Move move);
+void store_killer(Move* killers, Move move);
+bool move_is_quiet(FullMove move);
+bool move_is_killer(Move* killers, Move move);
 
 // Search stats
 void reset_search_stats(SearchAlg alg);
+void add_search_stats(SearchThread* thread);
 void print_search_stats();
 
 // Debugging
 void print_scored_move(ScoredMove move);
 bool check_if_legal(Move move, ScoredMove* legal_moves, int move_count);
 
-#define MAX_DEPTH 50
-#define KILLER_COUNT 2
-
 // Delta = the maximum piece value + som safety margin
 #define DELTA 950
 
-Move killer_moves[MAX_DEPTH][KILLER_COUNT];
-
 
-Move search_best_move(Board* board, AttackTable* attack_table, int depth, SearchAlg alg) {
-    clock_t start_time = clock();
+Move search_best_move(Board* board, const AttackTable* attack_table, TTable* t_table, int depth, SearchAlg alg) {
+    // Wall time, clock() would add up the time of all threads.
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
     reset_search_stats(alg);
-    int move_count = 0;
-
-    for (int i = 0 ; i < MAX_DEPTH ; i++) {
-        for (int j = 0 ; j < KILLER_COUNT ; j++) {
-            killer_moves[i][j] = move_create(0, 0 ,0);
-        }
-    }
 
     uint64_t attacked_squares = 0ULL;
-    Move* legal_moves = board_get_legal_moves(board, attack_table, &move_count, &attacked_squares);
-    ScoredMove* scored_moves = get_scored_moves(board, legal_moves, move_count, 0);
-    free(legal_moves);
-    order_moves_by_guess(board, scored_moves, move_count, NULL);
+    MoveList legal_moves;
+    ScoredMove scored_moves[MAX_LEGAL_MOVES];
+    generate_legal_moves(board, attack_table, &legal_moves, &attacked_squares);
+    get_scored_moves(board, &legal_moves, scored_moves, NULL);
+    order_moves_by_guess(board, scored_moves, legal_moves.count, NULL);
 
-    Move best_move = scored_moves[0].move;
+    Move best_move = full_move_get_move(scored_moves[0].move);
 
     //int score = alpha_beta(board, attack_table, LARGE_NEGATIVE, LARGE_POSITIVE, depth, depth, &best_move);
-    best_move = iterative_deepening(board, attack_table, depth);
+    TTable* search_table = t_table ? t_table : tt_create(TT_DEFAULT_SIZE_MB);
+    best_move = iterative_deepening(board, attack_table, search_table, depth);
+    if (!t_table) {
+        tt_destroy(search_table);
+    }
 
-    clock_t end_time = clock();
-    elapsed_time = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    elapsed_time = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
     best_move_found = best_move;
     //global_eval = board->turn ? score : -score;
 
-    board_push_move(best_move_found, board);
-    int static_eval = evaluate_board(board);
-    board_pop_move(board);
+    // Without a move to play, or with the game history full, the current position is evaluated.
+    int static_eval;
+    if (board_push_move(best_move_found, board)) {
+        static_eval = evaluate_board(board);
+        board_pop_move(board);
+    }
+    else {
+        static_eval = evaluate_board(board);
+    }
     global_static_eval = board->turn ? -static_eval : static_eval;
     //print_search_stats();
-    free(scored_moves);
 
     return best_move_found;
 }
 
+int search_get_node_count() {
+    return positions_searched + quiescence_searched;
+}
+
+double search_get_elapsed_time() {
+    return elapsed_time;
+}
+
+void search_set_thread_count(int count) {
+    thread_count = count < 1 ? 1 : (count > MAX_THREADS ? MAX_THREADS : count);
+}
+
 /*
  * Updates global_eval.
+ *
+ * The main thread searches on the given board, the helpers on their own copies. Only the main
+ * thread's result is used, the helpers just fill the shared transposition table.
  */
-Move iterative_deepening(Board* board, AttackTable* attack_table, int depth) {
-    int move_count = 0;
+Move iterative_deepening(Board* board, const AttackTable* attack_table, TTable* t_table, int depth) {
     uint64_t attacked_squares = 0ULL;
-    Move* legal_moves = board_get_legal_moves(board, attack_table, &move_count, &attacked_squares);
-    ScoredMove* scored_moves = get_scored_moves(board, legal_moves, move_count, 0);
-    free(legal_moves);
-    order_moves_by_guess(board, scored_moves, move_count, NULL);
-    TTable* t_table = tt_create(200);
-
-    Move current_best_move = scored_moves[0].move;
+    MoveList legal_moves;
+    ScoredMove scored_moves[MAX_LEGAL_MOVES];
+    generate_legal_moves(board, attack_table, &legal_moves, &attacked_squares);
+    get_scored_moves(board, &legal_moves, scored_moves, NULL);
+    order_moves_by_guess(board, scored_moves, legal_moves.count, NULL);
+    tt_new_search(t_table);
+
+    Move current_best_move = full_move_get_move(scored_moves[0].move);
+
+    __atomic_store_n(&stop_search, 0, __ATOMIC_RELAXED);
+    SearchThread* threads = malloc(thread_count * sizeof(SearchThread));
+    pthread_t* helpers = malloc(thread_count * sizeof(pthread_t));
+    search_thread_init(&threads[0], 0, board, attack_table, t_table, depth);
+    // If a helper can't be started the search goes on with the ones that were.
+    int started_count = 1;
+    for (int i = 1 ; i < thread_count ; i++) {
+        search_thread_init(&threads[i], i, board_copy(board), attack_table, t_table, depth);
+        if (pthread_create(&helpers[i], NULL, search_helper, &threads[i]) != 0) {
+            board_destroy(threads[i].board);
+            break;
+        }
+        started_count++;
+    }
 
     for (int current_depth = 1 ; current_depth <= depth ; current_depth++) {
         SearchParams params = (SearchParams) {
             .board = board,
             .attack_table = attack_table,
             .t_table = t_table,
+            .thread = &threads[0],
             .root_depth = current_depth,
         };
         int score = alpha_beta(params, LARGE_NEGATIVE, LARGE_POSITIVE, current_depth, 0, &current_best_move);
 
         global_eval = board->turn ? score : -score;
     }
+
+    __atomic_store_n(&stop_search, 1, __ATOMIC_RELAXED);
+    add_search_stats(&threads[0]);
+    for (int i = 1 ; i < started_count ; i++) {
+        pthread_join(helpers[i], NULL);
+        add_search_stats(&threads[i]);
+        board_destroy(threads[i].board);
+    }
+    free(helpers);
+    free(threads);
     
-    tt_destroy(t_table);
     return current_best_move;
 }
 
+void search_thread_init(SearchThread* thread, int index, Board* board, const AttackTable* attack_table, TTable* t_table, int depth) {
+    *thread = (SearchThread) {
+        .board = board,
+        .index = index,
+        .depth = depth,
+        .attack_table = attack_table,
+        .t_table = t_table,
+    };
+
+    for (int i = 0 ; i < MAX_DEPTH ; i++) {
+        for (int j = 0 ; j < KILLER_COUNT ; j++) {
+            thread->killer_moves[i][j] = move_create(0, 0 ,0);
+        }
+    }
+}
+
+/*
+ * Iterative deepening on a helper thread until the main thread is done. Odd helpers start one
+ * ply deeper so the threads spread out over depths instead of all searching the same tree, and
+ * all helpers go one ply past the main thread to keep feeding the table until they are stopped.
+ */
+void* search_helper(void* arg) {
+    SearchThread* thread = arg;
+    Move best_move = move_create(0, 0, 0);
+
+    for (int current_depth = 1 + thread->index % 2 ; current_depth <= thread->depth + 1 && current_depth < MAX_DEPTH ; current_depth++) {
+        SearchParams params = (SearchParams) {
+            .board = thread->board,
+            .attack_table = thread->attack_table,
+            .t_table = thread->t_table,
+            .thread = thread,
+            .root_depth = current_depth,
+        };
+        alpha_beta(params, LARGE_NEGATIVE, LARGE_POSITIVE, current_depth, 0, &best_move);
+
+        if (search_stopped(thread)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// Only helpers are stopped, the main thread always finishes its search.
+static inline bool search_stopped(SearchThread* thread) {
+    return thread->index != 0 && __atomic_load_n(&stop_search, __ATOMIC_RELAXED);
+}
+
 
 /*
  * Input best_move will be the first move evaluated during search. 
@@ -144,70 +270,77 @@ Move iterative_deepening(Board* board, AttackTable* attack_table, int depth) {
  */
 int alpha_beta(SearchParams params, int alpha, int beta, int depth, int ply, Move* best_move) {
     if (depth == 0) {
-        return search_captures_only(params.board, params.attack_table, params.t_table, alpha, beta, 0);
+        return search_captures_only(params, alpha, beta, 0);
+    }
+    SearchThread* thread = params.thread;
+    thread->positions_searched++;
+
+    bool is_root = depth == params.root_depth;
+    if (!is_root && board_is_repetition(params.board)) {
+        return 0;
     }
-    positions_searched++;
 
     uint64_t current_hash = board_get_zobrist_hash(params.board);
-    TTEntry* tt_entry = tt_lookup(params.t_table, current_hash, &tt_hits, &tt_lookups);
+    TTData tt_data;
+    TTData* tt_entry = tt_lookup(params.t_table, current_hash, &tt_data, &thread->tt_hits, &thread->tt_lookups) ? &tt_data : NULL;
     TTEntryType entry_type = TT_UPPER_BOUND;
 
-    if (tt_entry && tt_entry->depth >= depth -1 ) {
+    // No cutoffs at the root, it has to search to pick a move. The table outlives the search so it may know the root.
+    if (!is_root && tt_entry && tt_entry->depth >= depth -1 ) {
         if (tt_entry->entry_type == TT_EXACT) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return tt_entry->score;
         }
         if (tt_entry->entry_type == TT_UPPER_BOUND && tt_entry->score <= alpha) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return alpha;
         }
         if (tt_entry->entry_type == TT_LOWER_BOUND && tt_entry->score >= beta) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return beta;
         }
     }
-    if (tt_entry && move_exists(tt_entry->best_move) && depth != params.root_depth) {
-        *best_move = tt_entry->best_move;
+
+    // At root the best move from the previous iteration is tried first, otherwise the TT move
+    Move hash_move = move_create(0, 0, 0);
+    if (is_root) {
+        hash_move = *best_move;
+    }
+    else if (tt_entry) {
+        hash_move = tt_entry->best_move;
     }
 
+    // Shared by null move pruning and the move picker
+    CheckInfo check_info;
+    get_check_info(params.board, params.attack_table, &check_info);
+
     // Null move pruning:
-    int king_index;
     int r = 3;
-    uint64_t attacked_squares = 0ULL;
-    if (params.board->turn) {
-        king_index = __builtin_ctzll(params.board->bit_boards[WHITE_KING]);
-    }
-    else {
-        king_index = __builtin_ctzll(params.board->bit_boards[BLACK_KING]);
-    }
-    if (depth >= (r + 1) && !get_king_attackers(params.board, king_index, params.attack_table, &attacked_squares)) {
-        board_change_turn(params.board);
+    if (depth >= (r + 1) && !check_info.king_attackers) {
+        board_make_null_move(params.board);
         int score = -alpha_beta(params, -beta, -(beta - 1), depth - 1 - r, ply + 1, NULL);
-        board_change_turn(params.board);
+        board_unmake_null_move(params.board);
+        if (search_stopped(thread)) {
+            return 0;
+        }
         if (score >= beta) {
             return beta;
         }
     }
 
-    // Generate moves
-    int move_count = 0;
-    Move* legal_moves = board_get_legal_moves(params.board, params.attack_table, &move_count, &attacked_squares);
-    if (move_count == 0) {
-        if (params.root_depth == depth) {
-            *best_move = move_create(0, 0, 0);
-        }
-        free(legal_moves);
-        return LARGE_NEGATIVE;
-    }
-    ScoredMove* scored_moves = get_scored_moves(params.board, legal_moves, move_count, ply);
-    free(legal_moves);
+    MovePicker picker;
+    move_picker_init(&picker, params.board, params.attack_table, &check_info, hash_move, thread->killer_moves[ply]);
 
-    // Evaluate moves in guess-order with best_move first if it exists:
-    order_moves_by_guess(params.board, scored_moves, move_count, best_move);
-    board_change_turn(params.board);
+    Move node_best_move = move_create(0, 0, 0);
+    int move_count = 0;
     int bad_move_count = 0;
     int new_depth = depth - 1;
-    for (int i = 0 ; i < move_count ; i++) {
+    FullMove full_move;
+    while (move_exists(full_move_get_move(full_move = move_picker_next(&picker)))) {
+        Move move = full_move_get_move(full_move);
+        move_count++;
+        bool is_quiet = move_is_quiet(full_move);
+
         // Late move reductioins
         if (bad_move_count >= 3 && depth >= 3) {
             new_depth= depth - 2;
@@ -216,99 +349,90 @@ int alpha_beta(SearchParams params, int alpha, int beta, int depth, int ply, Mov
             new_depth = depth - 1;
         }
 
-        board_push_move(scored_moves[i].move, params.board);
+        Position saved;
+        board_make(full_move, params.board, &saved);
         int score = -alpha_beta(params, -beta, -alpha, new_depth, ply + 1, NULL);
-        board_pop_move(params.board);
+
+        if (score > alpha) {
+            bad_move_count = 0;
+            // If we searched at reduced depth and the move looks good we need to re-search at full depth
+            if (new_depth < depth - 1) {
+                new_depth = depth - 1;
+                score = -alpha_beta(params, -beta, -alpha, new_depth, ply + 1, NULL);
+            }
+        }
+        board_unmake(full_move, params.board, &saved);
+
+        // The scores of an abandoned search are meaningless, don't let them into the table.
+        if (search_stopped(thread)) {
+            return 0;
+        }
 
         if (score >= beta) {
             // This only happens if a mate is found at root level
-            if (depth == params.root_depth) {
-                *best_move = scored_moves[i].move;
+            if (is_root) {
+                *best_move = move;
             }
-            if (board_get_piece(scored_moves[i].move, params.board) == -1) {
-                store_killer(ply, scored_moves[i].move);
+            if (is_quiet) {
+                store_killer(thread->killer_moves[ply], move);
             }
-            board_change_turn(params.board);
-            tt_store(params.t_table, current_hash, new_depth, score, TT_LOWER_BOUND, move_create(0, 0, 0));
+            tt_store(params.t_table, current_hash, new_depth, score, TT_NO_EVAL, TT_LOWER_BOUND, move);
             return beta;
         }
 
         if (score > alpha) {
-            bad_move_count = 0;
-            // If we searched at reduced depth we need to re-search at full depth
-            if (new_depth < depth - 1) {
-                board_push_move(scored_moves[i].move, params.board);
-                int full_score = -alpha_beta(params, -beta, -alpha, depth -1, ply + 1, NULL);
-                board_pop_move(params.board);
-                if (full_score >= beta) {
-                    if (depth == params.root_depth) {
-                        *best_move = scored_moves[i].move;
-                    }
-                    if (board_get_piece(scored_moves[i].move, params.board) == -1) {
-                        store_killer(ply, scored_moves[i].move);
-                    }
-                    tt_store(params.t_table, current_hash, depth - 1, full_score, TT_LOWER_BOUND, move_create(0, 0, 0));
-                    board_change_turn(params.board);
-                    return beta;
-                }
-                if (full_score > alpha) {
-                    entry_type = TT_EXACT;
-                    alpha = full_score;
-                    if (depth == params.root_depth) {
-                        *best_move = scored_moves[i].move;
-                    }
-                }
-            }
-            else {
-                entry_type = TT_EXACT;
-                alpha = score;
-                if (depth == params.root_depth) {
-                    *best_move = scored_moves[i].move;
-                }
+            entry_type = TT_EXACT;
+            alpha = score;
+            node_best_move = move;
+            if (is_root) {
+                *best_move = move;
             }
         }
         bad_move_count++;
     }
 
-
-    free(scored_moves);
-    board_change_turn(params.board);
-
-    if (best_move) {
-        tt_store(params.t_table, current_hash, new_depth, alpha, entry_type, *best_move);
-    }
-    else {
-        tt_store(params.t_table, current_hash, new_depth, alpha, entry_type, move_create(0, 0, 0));
+    if (move_count == 0) {
+        if (is_root) {
+            *best_move = move_create(0, 0, 0);
+        }
+        return LARGE_NEGATIVE;
     }
 
+    tt_store(params.t_table, current_hash, new_depth, alpha, TT_NO_EVAL, entry_type, node_best_move);
+
     return alpha;
 }
 
 
-int search_captures_only(Board* board, AttackTable* attack_table, TTable* t_table, int alpha, int beta, int depth) {
-    quiescence_searched++;
+int search_captures_only(SearchParams params, int alpha, int beta, int depth) {
+    Board* board = params.board;
+    TTable* t_table = params.t_table;
+    SearchThread* thread = params.thread;
+    thread->quiescence_searched++;
 
     uint64_t current_hash = board_get_zobrist_hash(board);
-    TTEntry* tt_entry = tt_lookup(t_table, current_hash, &tt_hits, &tt_lookups);
+    TTData tt_data;
+    TTData* tt_entry = tt_lookup(t_table, current_hash, &tt_data, &thread->tt_hits, &thread->tt_lookups) ? &tt_data : NULL;
     TTEntryType entry_type = TT_UPPER_BOUND;
 
     if (tt_entry) {
         if (tt_entry->entry_type == TT_EXACT) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return tt_entry->score;
         }
         if (tt_entry->entry_type == TT_UPPER_BOUND && tt_entry->score <= alpha) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return alpha;
         }
         if (tt_entry->entry_type == TT_LOWER_BOUND && tt_entry->score >= beta) {
-            tt_pruning_hits++;
+            thread->tt_pruning_hits++;
             return beta;
         }
     }
 
-    int score = board_evaluate_current(board);
-    score = board->turn ? score : -score;
+    // The static eval is kept in the table too, it saves evaluating when only the bounds didn't cut.
+    int static_eval = tt_entry && tt_entry->static_eval != TT_NO_EVAL ? tt_entry->static_eval : board_evaluate_current(board);
+    int score = board->turn ? static_eval : -static_eval;
 
     if (score >= beta) {
         return beta;
@@ -316,7 +440,7 @@ int search_captures_only(Board* board, AttackTable* attack_table, TTable* t_tabl
 
     // Delta pruning
     if (score + DELTA < alpha) {
-        delta_prunes++;
+        thread->delta_prunes++;
         return alpha;
     }
 
@@ -326,29 +450,32 @@ int search_captures_only(Board* board, AttackTable* attack_table, TTable* t_tabl
     }
 
     uint64_t attacked_squares = 0ULL;
-    int move_count = 0;
-    Move* legal_captures = board_get_legal_captures(board, attack_table, &move_count, &attacked_squares);
+    MoveList legal_captures;
+    ScoredMove scored_moves[MAX_LEGAL_MOVES];
+    generate_legal_captures(board, params.attack_table, &legal_captures, &attacked_squares);
+    int move_count = legal_captures.count;
 
     if (move_count == 0) {
         return score;
     }
 
-    ScoredMove* scored_moves = get_scored_moves(board, legal_captures, move_count, 0);
-    free(legal_captures);
+    get_scored_moves(board, &legal_captures, scored_moves, NULL);
 
     //Move* best_move = (tt_entry && move_exists(tt_entry->best_move)) ? &(tt_entry->best_move) : NULL;
     order_moves_by_guess(board, scored_moves, move_count, NULL);
 
+    Position saved;
     for (int i = 0 ; i < move_count ; i++) {
-        board_push_move(scored_moves[i].move, board);
-        board_change_turn(board);
-        score = -search_captures_only(board, attack_table, t_table, -beta, -alpha, depth + 1);
-        board_pop_move(board);
-        board_change_turn(board);
+        board_make(scored_moves[i].move, board, &saved);
+        score = -search_captures_only(params, -beta, -alpha, depth + 1);
+        board_unmake(scored_moves[i].move, board, &saved);
+
+        if (search_stopped(thread)) {
+            return 0;
+        }
 
         if (score >= beta) {
-            free(scored_moves);
-            tt_store(t_table, current_hash, -1, score, TT_LOWER_BOUND, move_create(0, 0, 0));
+            tt_store(t_table, current_hash, -1, score, static_eval, TT_LOWER_BOUND, move_create(0, 0, 0));
             return beta;
         }
 
@@ -358,41 +485,42 @@ int search_captures_only(Board* board, AttackTable* attack_table, TTable* t_tabl
         }
     }
 
-    free(scored_moves);
-
-    tt_store(t_table, current_hash, -1, alpha, entry_type, move_create(0, 0, 0));
+    tt_store(t_table, current_hash, -1, alpha, static_eval, entry_type, move_create(0, 0, 0));
 
     return alpha;
 }
 
-void store_killer(int ply, Move move) {
-    if (killer_moves[ply][0] != move) {
-        killer_moves[ply][1] = killer_moves[ply][0];
-        killer_moves[ply][0] = move;
+void store_killer(Move* killers, Move move) {
+    if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
     }
 }
 
-bool move_is_killer(int ply, Move move) {
-    return killer_moves[ply][0] == move || killer_moves[ply][1] == move;
+bool move_is_quiet(FullMove move) {
+    MoveFlag flag = move_get_flag(move);
+    bool is_promotion = flag >= QUEEN_PROMOTION_FLAG && flag <= KNIGHT_PROMOTION_FLAG;
+    return full_move_get_captured_piece(move) == -1 && !is_promotion;
 }
 
-ScoredMove* get_scored_moves(Board* board, Move* moves, int move_count, int ply) {
-    ScoredMove* scored_moves = calloc(move_count, sizeof(ScoredMove));
+bool move_is_killer(Move* killers, Move move) {
+    return killers[0] == move || killers[1] == move;
+}
 
-    for (int i = 0 ; i < move_count ; i++) {
-        scored_moves[i].move = moves[i];
-        scored_moves[i].guess_score = get_move_score(board, scored_moves[i].move, ply);
+// killers may be NULL when there are none, such as at the root or for captures only.
+void get_scored_moves(Board* board, MoveList* move_list, ScoredMove* scored_moves, Move* killers) {
+    for (int i = 0 ; i < move_list->count ; i++) {
+        scored_moves[i].move = move_list->moves[i];
+        scored_moves[i].guess_score = get_move_score(board, scored_moves[i].move, killers);
     }
-
-    return scored_moves;
 }
 
-int get_move_score(Board* board, Move move, int ply) {
-    PieceType from_piece = board_get_piece(move_get_from_index(move), board);
-    PieceType to_piece = board_get_piece(move_get_to_index(move), board);
+int get_move_score(Board* board, FullMove move, Move* killers) {
+    PieceType from_piece = full_move_get_piece(move);
+    PieceType to_piece = full_move_get_captured_piece(move);
     
     if (to_piece == -1) {
-        if (move_is_killer(ply, move)) {
+        if (killers && move_is_killer(killers, full_move_get_move(move))) {
             return 300;
         }
         else {
@@ -410,7 +538,7 @@ void order_moves_by_guess(Board* board, ScoredMove* scored_moves, int move_count
 
     if (best_move && move_count > 1) {
         for (int i = 0 ; i < move_count ; i++) {
-            if (scored_moves[i].move == *best_move) {
+            if (full_move_get_move(scored_moves[i].move) == *best_move) {
                 ScoredMove temp = scored_moves[i];
                 scored_moves[i] = scored_moves[0];
                 scored_moves[0] = temp;
@@ -459,6 +587,15 @@ void reset_search_stats(SearchAlg alg) {
     delta_prunes = 0;
 }
 
+void add_search_stats(SearchThread* thread) {
+    positions_searched += thread->positions_searched;
+    quiescence_searched += thread->quiescence_searched;
+    tt_hits += thread->tt_hits;
+    tt_pruning_hits += thread->tt_pruning_hits;
+    tt_lookups += thread->tt_lookups;
+    delta_prunes += thread->delta_prunes;
+}
+
 
 void print_search_stats() {
     printf("\n");
@@ -486,12 +623,13 @@ void print_search_stats() {
 }
 
 
-void test_search(Board* board, AttackTable* attack_table) {
-    int move_count = 0;
+void test_search(Board* board, const AttackTable* attack_table) {
     uint64_t attacked_squares = 0ULL;
-    Move* legal_moves = board_get_legal_moves(board, attack_table, &move_count, &attacked_squares);
-    ScoredMove* scored_moves = get_scored_moves(board, legal_moves, move_count ,0);
-    free(legal_moves);
+    MoveList legal_moves;
+    ScoredMove scored_moves[MAX_LEGAL_MOVES];
+    generate_legal_moves(board, attack_table, &legal_moves, &attacked_squares);
+    get_scored_moves(board, &legal_moves, scored_moves, NULL);
+    int move_count = legal_moves.count;
 
 
     Move best_move = move_create(11, 2, 0);
@@ -505,7 +643,7 @@ void test_search(Board* board, AttackTable* attack_table) {
 
 bool check_if_legal(Move move, ScoredMove* legal_moves, int move_count) {
     for (int i = 0 ; i < move_count ; i++) {
-        if (move == legal_moves[i].move) {
+        if (move == full_move_get_move(legal_moves[i].move)) {
             return true;
         }
     }
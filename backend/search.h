@@ -14,8 +14,21 @@ typedef enum {
 
 
 
-Move search_best_move(Board* board, AttackTable* attack_table, int depth, SearchAlg alg);
+/*
+ * t_table is kept between searches by the caller. If it is NULL a table is created for this
+ * search only.
+ */
+Move search_best_move(Board* board, const AttackTable* attack_table, TTable* t_table, int depth, SearchAlg alg);
 
-void test_search(Board* board, AttackTable* attack_table);
+// Nodes visited by the last search, quiescence nodes included and summed over all threads.
+int search_get_node_count();
+
+// Wall time of the last search in seconds.
+double search_get_elapsed_time();
+
+// Lazy SMP: this many threads search the same root and share the transposition table.
+void search_set_thread_count(int count);
+
+void test_search(Board* board, const AttackTable* attack_table);
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "move.h"
 
 typedef enum {
@@ -11,29 +12,74 @@ typedef enum {
     TT_LOWER_BOUND
 } TTEntryType;
 
+#define TT_CLUSTER_SIZE 4
+// Ages are kept in 5 bits and wrap around.
+#define TT_AGE_COUNT 32
+// Stored when there is no static eval for the position.
+#define TT_NO_EVAL INT16_MIN
+
+/*
+ * Search threads share the table without locks. The key is stored XORed with the data, so an
+ * entry torn by a concurrent write fails the key check instead of being used. Data is packed as
+ * best_move | score << 16 | static_eval << 32 | depth << 48 | type << 56 | active << 58 | age << 59,
+ * so scores and evals have to fit in 16 bits.
+ */
+typedef struct {
+    uint64_t key;
+    uint64_t data;
+} TTEntry;
+
+/*
+ * The entries a key can go in, one cache line so that a probe only touches one line. This holds
+ * as many entries per MB as a flat array of TTEntry, it only gives a store four entries to pick from.
+ */
+typedef struct {
+    TTEntry entries[TT_CLUSTER_SIZE];
+} TTCluster;
+
+// An entry unpacked by tt_lookup, a copy so that later writes to the table can't change it.
 typedef struct {
-    bool is_active;
-    uint64_t zobrist_key;
     TTEntryType entry_type;
     int score;
+    int static_eval;
     int depth;
     int age;
     Move best_move;
-} TTEntry;
+} TTData;
 
 typedef struct {
-    int capacity;
-    int entry_count;
-    int current_age;
-    TTEntry* data;
+    int cluster_count;
+    int current_age;        // Bumped by tt_new_search, entries from earlier searches are replaced first.
+    TTCluster* clusters;    // 64-byte aligned inside allocation
+    void* allocation;
 } TTable;
 
+#define TT_DEFAULT_SIZE_MB 200
+// The range of the UCI Hash option.
+#define TT_MIN_SIZE_MB 1
+#define TT_MAX_SIZE_MB 16384
+
+// Returns NULL if the table can't be allocated.
 TTable* tt_create(int size_MB);
 
-void tt_store(TTable* t_table, uint64_t zobrist_key, int depth, int score, TTEntryType type, Move best_move);
+// Empties the table. The memory is handed back and calloced again, so it is zeroed lazily.
+void tt_clear(TTable* t_table);
+
+// Reallocates the table with a new size, its entries are lost. Returns false and keeps the old
+// table if the new one can't be allocated.
+bool tt_resize(TTable* t_table, int size_MB);
 
-TTEntry* tt_lookup(TTable* t_table, uint64_t zobrist_key, int* tt_hits, int* tt_lookups);
+// Starts a new generation, call once per search.
+void tt_new_search(TTable* t_table);
+
+void tt_store(TTable* t_table, uint64_t zobrist_key, int depth, int score, int static_eval, TTEntryType type, Move best_move);
+
+// Returns true and fills entry if the key is in the table.
+bool tt_lookup(TTable* t_table, uint64_t zobrist_key, TTData* entry, int* tt_hits, int* tt_lookups);
 
 void tt_destroy(TTable* t_table);
 
+// The largest power of two number of entries that fits in size_MB. Shared with other hash tables.
+size_t tt_get_capacity(int size_MB, size_t entry_size);
+
 #endif
\ No newline at end of file
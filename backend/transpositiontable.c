@@ -1,74 +1,171 @@
-
 #include <stdlib.h>
 #include "transpositiointable.h"
 #include <stdio.h>
+#include <string.h>
 
+#define TT_ACTIVE (1ULL << 58)
+#define CACHE_LINE_SIZE 64
+// How many plies of depth one search of age is worth when picking an entry to replace.
+#define TT_AGE_WEIGHT 8
 
-static int nearest_power_of_two(int n);
+static size_t nearest_power_of_two(size_t n);
+static inline uint64_t tt_pack(int depth, int score, int static_eval, TTEntryType type, int age, Move best_move);
+static inline int tt_data_depth(uint64_t data);
+static inline int tt_data_age(TTable* t_table, uint64_t data);
+static bool tt_allocate(TTable* t_table, int cluster_count);
 
 TTable* tt_create(int size_MB) {
     TTable* t_table = malloc(sizeof(TTable));
+    if (!t_table) {
+        return NULL;
+    }
 
-    int capacity = (size_MB * 1024ULL * 1024ULL) / sizeof(TTEntry);
-    t_table->capacity = nearest_power_of_two(capacity);
-    t_table->data = calloc(t_table->capacity, sizeof(TTEntry));
-    t_table->entry_count = 0;
+    t_table->allocation = NULL;
+    if (!tt_allocate(t_table, tt_get_capacity(size_MB, sizeof(TTCluster)))) {
+        free(t_table);
+        return NULL;
+    }
     t_table->current_age = 0;
 
-    for (int i = 0 ; i < t_table->capacity ; i++) {
-        t_table->data[i].is_active = false;
-        t_table->data[i].best_move = move_create(0, 0, 0);
+    return t_table;
+}
+
+void tt_clear(TTable* t_table) {
+    // If a fresh block can't be had, zero the old one in place instead.
+    if (!tt_allocate(t_table, t_table->cluster_count)) {
+        memset(t_table->clusters, 0, t_table->cluster_count * sizeof(TTCluster));
     }
+}
 
-    return t_table;
+bool tt_resize(TTable* t_table, int size_MB) {
+    return tt_allocate(t_table, tt_get_capacity(size_MB, sizeof(TTCluster)));
+}
+
+void tt_new_search(TTable* t_table) {
+    t_table->current_age = (t_table->current_age + 1) % TT_AGE_COUNT;
 }
 
-void tt_store(TTable* t_table, uint64_t zobrist_key, int depth, int score, TTEntryType type, Move best_move) {
-    // For some reason this is the same as zobrist_key % capacity :o
-    int index = zobrist_key & (t_table->capacity - 1);
-    
-    if (t_table->data[index].is_active && t_table->data[index].depth > depth) {
+/*
+ * Replaces the entry with the same key, else an empty one, else the one in the cluster with
+ * the lowest depth minus TT_AGE_WEIGHT per search since it was stored. Entries from the
+ * current search are still not replaced by a shallower one, older ones always are.
+ */
+void tt_store(TTable* t_table, uint64_t zobrist_key, int depth, int score, int static_eval, TTEntryType type, Move best_move) {
+    TTCluster* cluster = &t_table->clusters[zobrist_key & (t_table->cluster_count - 1)];
+    TTEntry* replace = NULL;
+    uint64_t replace_data = 0;
+    int replace_score = 0;
+
+    // A torn read here only affects which entry is replaced.
+    for (int i = 0 ; i < TT_CLUSTER_SIZE ; i++) {
+        TTEntry* entry = &cluster->entries[i];
+        uint64_t data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+        uint64_t key = __atomic_load_n(&entry->key, __ATOMIC_RELAXED);
+
+        if (!(data & TT_ACTIVE) || (key ^ data) == zobrist_key) {
+            replace = entry;
+            replace_data = data;
+            break;
+        }
+
+        int entry_score = tt_data_depth(data) - TT_AGE_WEIGHT * tt_data_age(t_table, data);
+        if (!replace || entry_score < replace_score) {
+            replace = entry;
+            replace_data = data;
+            replace_score = entry_score;
+        }
+    }
+
+    if ((replace_data & TT_ACTIVE) && tt_data_age(t_table, replace_data) == 0 && tt_data_depth(replace_data) > depth) {
         return;
     }
 
-    TTEntry new_entry = (TTEntry) {
-        .zobrist_key = zobrist_key,
-        .entry_type = type,
-        .score = score,
-        .depth = depth,
-        .age = t_table->current_age,
-        .best_move = best_move,
-        .is_active = true
-    };
-
-    t_table->data[index] = new_entry;
+    uint64_t data = tt_pack(depth, score, static_eval, type, t_table->current_age, best_move);
+    __atomic_store_n(&replace->key, zobrist_key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&replace->data, data, __ATOMIC_RELAXED);
 }
 
 
-TTEntry* tt_lookup(TTable* t_table, uint64_t zobrist_key, int* tt_hits, int* tt_lookups) {
-    int index = zobrist_key & (t_table->capacity - 1);
-    TTEntry* entry = &(t_table->data[index]);
+bool tt_lookup(TTable* t_table, uint64_t zobrist_key, TTData* entry, int* tt_hits, int* tt_lookups) {
+    TTCluster* cluster = &t_table->clusters[zobrist_key & (t_table->cluster_count - 1)];
     (*tt_lookups)++;
 
-    if (entry->is_active && entry->zobrist_key == zobrist_key) {
+    for (int i = 0 ; i < TT_CLUSTER_SIZE ; i++) {
+        uint64_t key = __atomic_load_n(&cluster->entries[i].key, __ATOMIC_RELAXED);
+        uint64_t data = __atomic_load_n(&cluster->entries[i].data, __ATOMIC_RELAXED);
+        if (!(data & TT_ACTIVE) || (key ^ data) != zobrist_key) {
+            continue;
+        }
+
+        *entry = (TTData) {
+            .best_move = data & 0xFFFF,
+            .score = (int16_t)(data >> 16),
+            .static_eval = (int16_t)(data >> 32),
+            .depth = tt_data_depth(data),
+            .entry_type = (data >> 56) & 0x3,
+            .age = data >> 59,
+        };
         (*tt_hits)++;
-        return entry;
+
+        return true;
     }
 
-    return NULL;
+    return false;
 }
 
 
+size_t tt_get_capacity(int size_MB, size_t entry_size) {
+    size_t capacity = (size_t)size_MB * 1024 * 1024 / entry_size;
+    return nearest_power_of_two(capacity);
+}
+
 void tt_destroy(TTable* t_table) {
-    free(t_table->data);
+    free(t_table->allocation);
     free(t_table);
 }
 
 
-static int nearest_power_of_two(int n) {
-    int p = 1;
+/*
+ * A zeroed entry is inactive, so calloc is enough and large tables come from pages the OS
+ * zeroes on first touch. One cluster extra is allocated so the clusters can start on a cache line.
+ * The old block is only freed once the new one is allocated, so on failure the table is unchanged.
+ */
+static bool tt_allocate(TTable* t_table, int cluster_count) {
+    void* allocation = calloc(cluster_count + 1, sizeof(TTCluster));
+    if (!allocation) {
+        return false;
+    }
+
+    free(t_table->allocation);
+    t_table->cluster_count = cluster_count;
+    t_table->allocation = allocation;
+    t_table->clusters = (TTCluster*)(((uintptr_t)allocation + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    return true;
+}
+
+static size_t nearest_power_of_two(size_t n) {
+    size_t p = 1;
     while (p * 2 <= n) {
         p *= 2;
     }
     return p;
+}
+
+static inline uint64_t tt_pack(int depth, int score, int static_eval, TTEntryType type, int age, Move best_move) {
+    return (uint64_t)best_move
+         | (uint64_t)(uint16_t)score << 16
+         | (uint64_t)(uint16_t)static_eval << 32
+         | (uint64_t)(uint8_t)depth << 48
+         | (uint64_t)type << 56
+         | TT_ACTIVE
+         | (uint64_t)(age % TT_AGE_COUNT) << 59;
+}
+
+static inline int tt_data_depth(uint64_t data) {
+    return (int8_t)(data >> 48);
+}
+
+// How many searches ago the entry was stored.
+static inline int tt_data_age(TTable* t_table, uint64_t data) {
+    return (t_table->current_age - (int)(data >> 59) + TT_AGE_COUNT) % TT_AGE_COUNT;
 }
\ No newline at end of file
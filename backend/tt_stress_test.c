@@ -0,0 +1,117 @@
+/*
+ * Stress test for the lockless transposition table. Several threads store and look up keys that
+ * all map to a few clusters of a small table, so entries are constantly overwritten while other
+ * threads read them. Every key is always stored with data derived from the key itself, so a hit
+ * carrying any other data is an entry torn by a concurrent write that the key check let through.
+ *
+ * Usage: make tt_stress_test
+ */
+
+#include "transpositiointable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define THREAD_COUNT 8
+#define ITERATIONS 20000000
+#define KEY_COUNT 64
+// The keys only differ above these bits, so they share CLUSTER_COUNT clusters.
+#define CLUSTER_BITS 16
+#define CLUSTER_COUNT 2
+
+typedef struct {
+    TTable* t_table;
+    const uint64_t* keys;
+    uint64_t seed;
+    long hits;
+    long torn;
+} StressThread;
+
+static uint64_t next_random(uint64_t* state);
+static void expected_data(uint64_t key, TTData* data);
+static void* hammer(void* arg);
+
+int main() {
+    TTable* t_table = tt_create(1);
+    uint64_t keys[KEY_COUNT];
+    uint64_t state = 1;
+
+    for (int i = 0 ; i < KEY_COUNT ; i++) {
+        keys[i] = (next_random(&state) & ~((1ULL << CLUSTER_BITS) - 1)) | (i % CLUSTER_COUNT);
+    }
+
+    pthread_t threads[THREAD_COUNT];
+    StressThread stress_threads[THREAD_COUNT];
+    for (int i = 0 ; i < THREAD_COUNT ; i++) {
+        stress_threads[i] = (StressThread) {.t_table = t_table, .keys = keys, .seed = i + 1};
+        pthread_create(&threads[i], NULL, hammer, &stress_threads[i]);
+    }
+
+    long hits = 0;
+    long torn = 0;
+    for (int i = 0 ; i < THREAD_COUNT ; i++) {
+        pthread_join(threads[i], NULL);
+        hits += stress_threads[i].hits;
+        torn += stress_threads[i].torn;
+    }
+
+    tt_destroy(t_table);
+    printf("%d threads, %ld hits, %ld torn entries read\n", THREAD_COUNT, hits, torn);
+
+    bool passed = torn == 0 && hits > 0;
+    printf("%s\n", passed ? "OK" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+/* ------------------- Internal functions --------------------*/
+
+// xorshift64*, each thread has its own state.
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// The only data a key is ever stored with. Every field depends on the key.
+static void expected_data(uint64_t key, TTData* data) {
+    data->depth = (int)(key % 60) - 1;
+    data->score = (int)((key >> 8) % 60001) - 30000;
+    data->static_eval = (int)((key >> 16) % 20001) - 10000;
+    data->entry_type = key % 3;
+    data->best_move = (key >> 32) & 0xFFFF;
+}
+
+static void* hammer(void* arg) {
+    StressThread* thread = arg;
+    uint64_t state = thread->seed;
+    int tt_hits = 0;
+    int tt_lookups = 0;
+
+    for (int i = 0 ; i < ITERATIONS ; i++) {
+        uint64_t random = next_random(&state);
+        uint64_t key = thread->keys[random % KEY_COUNT];
+        TTData expected;
+        expected_data(key, &expected);
+
+        if (random & (1ULL << 63)) {
+            tt_store(thread->t_table, key, expected.depth, expected.score, expected.static_eval,
+                     expected.entry_type, expected.best_move);
+            continue;
+        }
+
+        TTData entry;
+        if (!tt_lookup(thread->t_table, key, &entry, &tt_hits, &tt_lookups)) {
+            continue;
+        }
+
+        thread->hits++;
+        if (entry.depth != expected.depth || entry.score != expected.score ||
+            entry.static_eval != expected.static_eval || entry.entry_type != expected.entry_type ||
+            entry.best_move != expected.best_move) {
+            thread->torn++;
+        }
+    }
+
+    return NULL;
+}
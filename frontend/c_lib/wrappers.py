@@ -35,30 +35,49 @@ class SearchAlg(IntEnum):
     ITERATIVE_DEEPENING = 3
 
 
+# Same as in board.h
+UNDO_STACK_CAPACITY = 1024 + 128
+
+
 class UndoNode(ctypes.Structure):
     _fields_ = [
-        ("move", ctypes.c_uint16),
+        ("move", ctypes.c_uint32),
         ("en_passant_index", ctypes.c_int8),
-        ("move_piece", ctypes.c_int8),
-        ("captured_piece", ctypes.c_int8),
         ("castling_rights", ctypes.c_uint8),
+        ("zobrist_hash", ctypes.c_uint64),
     ]
 
 
 class Board(ctypes.Structure):
     _fields_ = [
         ("bit_boards", ctypes.c_uint64 * 14),
+        ("pieces", ctypes.c_int8 * 64),
         ("en_passant_index", ctypes.c_int8),
         ("turn", ctypes.c_bool),
         ("castling_rights", ctypes.c_uint8),
-        ("undo_stack", ctypes.POINTER(UndoNode)),
-        ("undo_stack_size", ctypes.c_int),
-        ("undo_stack_capacity", ctypes.c_int),
         ("current_zobrist_hash", ctypes.c_uint64),
+        ("pawn_zobrist_hash", ctypes.c_uint64),
+        ("material_key", ctypes.c_uint64),
+        ("material", ctypes.c_int16 * 2),
+        ("piece_square", ctypes.c_int16 * 2),
+        ("undo_stack_size", ctypes.c_int),
+        ("undo_stack", UndoNode * UNDO_STACK_CAPACITY),
     ]
 
 
-class AttackTable(ctypes.Structure):
+class Magic(ctypes.Structure):
+    _fields_ = [
+        ("mask", ctypes.c_uint64),
+        ("magic", ctypes.c_uint64),
+        ("shift", ctypes.c_int),
+        ("offset", ctypes.c_int),
+    ]
+
+
+ROOK_ATTACKS_SIZE = 102400
+BISHOP_ATTACKS_SIZE = 5248
+
+class AttackTableCommon(ctypes.Structure):
     _fields_ = [
         ("king_table", ctypes.c_uint64 * 64),
         ("queen_table", ctypes.c_uint64 * 64),
@@ -69,13 +88,26 @@ class AttackTable(ctypes.Structure):
         ("black_pawn_table", ctypes.c_uint64 * 64),
         ("white_pawn_attack_table", ctypes.c_uint64 * 64),
         ("black_pawn_attack_table", ctypes.c_uint64 * 64),
-        ("ray_dir_table", ctypes.c_uint64 * 64 * 8),
+        ("between", ctypes.c_uint64 * 64 * 64),
+        ("line", ctypes.c_uint64 * 64 * 64),
+    ]
+
+
+# Points into the library's read-only data, never write through it.
+class AttackTable(ctypes.Structure):
+    _fields_ = [
+        ("common", ctypes.POINTER(AttackTableCommon)),
+        ("rook_magics", Magic * 64),
+        ("bishop_magics", Magic * 64),
+        ("rook_attacks", ctypes.c_uint64 * ROOK_ATTACKS_SIZE),
+        ("bishop_attacks", ctypes.c_uint64 * BISHOP_ATTACKS_SIZE),
+        ("use_pext", ctypes.c_bool),
     ]
 
 
 class ScoredMove(ctypes.Structure):
     _fields_ = [
-        ("move", ctypes.c_uint16),
+        ("move", ctypes.c_uint32),
         ("eval_score", ctypes.c_int),
         ("guess_score", ctypes.c_int),
     ]
@@ -88,21 +120,34 @@ class TTEntryType(ctypes.c_int):
 
 class TTEntry(ctypes.Structure):
     _fields_ = [
-        ("is_active", ctypes.c_bool),
-        ("zobrist_key", ctypes.c_uint64),
+        ("key", ctypes.c_uint64),
+        ("data", ctypes.c_uint64),
+    ]
+
+class TTData(ctypes.Structure):
+    _fields_ = [
         ("entry_type", ctypes.c_int),
         ("score", ctypes.c_int),
+        ("static_eval", ctypes.c_int),
         ("depth", ctypes.c_int),
         ("age", ctypes.c_int),
         ("best_move", ctypes.c_uint16),
     ]
 
+TT_CLUSTER_SIZE = 4
+TT_NO_EVAL = -32768
+
+class TTCluster(ctypes.Structure):
+    _fields_ = [
+        ("entries", TTEntry * TT_CLUSTER_SIZE),
+    ]
+
 class TTable(ctypes.Structure):
     _fields_ = [
-        ("capacity", ctypes.c_int),
-        ("entry_count", ctypes.c_int),
+        ("cluster_count", ctypes.c_int),
         ("current_age", ctypes.c_int),
-        ("data", ctypes.POINTER(TTEntry)),
+        ("clusters", ctypes.POINTER(TTCluster)),
+        ("allocation", ctypes.c_void_p),
     ]
 
 def tt_create(chess_lib, size_MB):
@@ -112,11 +157,37 @@ def tt_create(chess_lib, size_MB):
     return chess_lib.tt_create(ctypes.c_int(size_MB))
 
 
-def tt_store(chess_lib, t_table, key, depth, score, enttry_type, best_move):
-    pass
+def tt_store(chess_lib, t_table, key, depth, score, entry_type, best_move, static_eval=TT_NO_EVAL):
+    chess_lib.tt_store.argtypes = [ctypes.POINTER(TTable), ctypes.c_uint64, ctypes.c_int, ctypes.c_int,
+                                   ctypes.c_int, ctypes.c_int, ctypes.c_uint16]
+    chess_lib.tt_store.restype = None
 
-def tt_lookup(t_table, key):
-    pass
+    chess_lib.tt_store(t_table, key, depth, score, static_eval, entry_type, best_move)
+
+def tt_lookup(chess_lib, t_table, key):
+    """Returns the TTData stored for key, or None."""
+    chess_lib.tt_lookup.argtypes = [ctypes.POINTER(TTable), ctypes.c_uint64, ctypes.POINTER(TTData),
+                                    ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_int)]
+    chess_lib.tt_lookup.restype = ctypes.c_bool
+
+    entry = TTData()
+    hits = ctypes.c_int(0)
+    lookups = ctypes.c_int(0)
+    if chess_lib.tt_lookup(t_table, key, ctypes.pointer(entry), ctypes.pointer(hits), ctypes.pointer(lookups)):
+        return entry
+    return None
+
+def tt_new_search(chess_lib, t_table):
+    chess_lib.tt_new_search.argtypes = [ctypes.POINTER(TTable)]
+    chess_lib.tt_new_search.restype = None
+
+    chess_lib.tt_new_search(t_table)
+
+def tt_destroy(chess_lib, t_table):
+    chess_lib.tt_destroy.argtypes = [ctypes.POINTER(TTable)]
+    chess_lib.tt_destroy.restype = None
+
+    chess_lib.tt_destroy(t_table)
 
 def board_create_w(chess_lib):
     chess_lib.board_create.argtypes = []
@@ -147,9 +218,9 @@ def board_change_turn(chess_lib, board):
 
 def board_push_move(chess_lib, move, board):
     chess_lib.board_push_move.argtypes = [ctypes.c_uint16, ctypes.POINTER(Board)]
-    chess_lib.board_push_move.restype = None
+    chess_lib.board_push_move.restype = ctypes.c_bool
 
-    chess_lib.board_push_move(move, board)
+    return chess_lib.board_push_move(move, board)
 
 def board_pop_move(chess_lib, board):
     chess_lib.board_pop_move.argtypes = [ctypes.POINTER(Board)]
@@ -176,11 +247,13 @@ def board_evaluate_current(chess_lib, board):
     return chess_lib.board_evaluate_current(board)
 
 def board_get_legal_captures(chess_lib, board, attack_table):
-    chess_lib.board_get_legal_captures.argtypes = [ctypes.POINTER(Board), ctypes.POINTER(AttackTable), ctypes.POINTER(ctypes.c_int)]
+    chess_lib.board_get_legal_captures.argtypes = [ctypes.POINTER(Board), ctypes.POINTER(AttackTable),
+                                                   ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_uint64)]
     chess_lib.board_get_legal_captures.restype = ctypes.POINTER(ctypes.c_uint16)
 
     move_count = ctypes.c_int(0)
-    legal_moves = chess_lib.board_get_legal_captures(board, attack_table, ctypes.pointer(move_count))
+    dummy_val = ctypes.c_uint64(0)
+    legal_moves = chess_lib.board_get_legal_captures(board, attack_table, ctypes.pointer(move_count), ctypes.pointer(dummy_val))
 
     return legal_moves[:move_count.value], move_count.value
 
@@ -198,11 +271,13 @@ def board_get_fen_w(chess_lib, board):
     fen_ptr = chess_lib.board_get_fen(board)
     return ctypes.string_at(fen_ptr).decode('utf-8')
 
-def search_best_move(chess_lib, board, attack_table, depth, algorithm):
-    chess_lib.search_best_move.argtypes = [ctypes.POINTER(Board), ctypes.POINTER(AttackTable), ctypes.c_int, ctypes.c_int]
+def search_best_move(chess_lib, board, attack_table, depth, algorithm, t_table=None):
+    """Without a t_table the search creates its own for this move only."""
+    chess_lib.search_best_move.argtypes = [ctypes.POINTER(Board), ctypes.POINTER(AttackTable), ctypes.POINTER(TTable),
+                                           ctypes.c_int, ctypes.c_int]
     chess_lib.search_best_move.restype = ctypes.c_uint16
 
-    return chess_lib.search_best_move(board, attack_table, ctypes.c_int(depth), algorithm)
+    return chess_lib.search_best_move(board, attack_table, t_table, ctypes.c_int(depth), algorithm)
 
 def attack_table_create_w(chess_lib):
     chess_lib.attack_table_create.argtypes = []
@@ -0,0 +1,88 @@
+import ctypes
+from c_lib import wrappers
+
+PROMOTION_FLAGS = set([wrappers.MoveFlag.QUEEN_PROMOTION_FLAG, wrappers.MoveFlag.ROOK_PROMOTION_FLAG,
+                       wrappers.MoveFlag.BISHOP_PROMOTION_FLAG, wrappers.MoveFlag.KNIGHT_PROMOTION_FLAG])
+
+
+def is_capture(chess_lib, board, move):
+    """The filter the old capture generator used on the full move list."""
+    if wrappers.move_get_flag(chess_lib, move) == wrappers.MoveFlag.EN_PASSANT_FLAG:
+        return True
+
+    to_index = wrappers.move_get_to_index(chess_lib, move)
+    piece = wrappers.board_get_piece_w(chess_lib, to_index, board)
+    if piece == -1:
+        return False
+
+    enemy_is_white = not board.contents.turn
+    return (piece < wrappers.PieceType.WHITE_PIECES) == enemy_is_white
+
+
+def compare_captures(chess_lib, board, attack_table):
+    legal_moves, _ = wrappers.get_legal_moves_w(chess_lib, board, attack_table)
+    legal_captures, _ = wrappers.board_get_legal_captures(chess_lib, board, attack_table)
+
+    filtered = [move for move in legal_moves if is_capture(chess_lib, board, move)]
+    quiet_promotions = [move for move in legal_moves if not is_capture(chess_lib, board, move)
+                        and wrappers.move_get_flag(chess_lib, move) in PROMOTION_FLAGS]
+    expected = sorted(filtered + quiet_promotions)
+
+    if sorted(legal_captures) != expected:
+        print("CAPTURE MISSMATCH!")
+        print(wrappers.board_get_fen_w(chess_lib, board))
+        print("Expected:", expected)
+        print("Generated:", sorted(legal_captures))
+        return 1
+
+    return 0
+
+
+def walk(chess_lib, board, attack_table, depth):
+    """Compares the capture generator with the filtered move list in every position of the tree."""
+    errors = compare_captures(chess_lib, board, attack_table)
+    if depth == 0:
+        return errors, 1
+
+    positions = 1
+    legal_moves, _ = wrappers.get_legal_moves_w(chess_lib, board, attack_table)
+    for move in legal_moves:
+        wrappers.board_push_move(chess_lib, move, board)
+        wrappers.board_change_turn(chess_lib, board)
+
+        sub_errors, sub_positions = walk(chess_lib, board, attack_table, depth - 1)
+        errors += sub_errors
+        positions += sub_positions
+
+        wrappers.board_pop_move(chess_lib, board)
+        wrappers.board_change_turn(chess_lib, board)
+
+    return errors, positions
+
+
+def main():
+    ctypes.cdll.LoadLibrary("../backend/shared_lib/shared_lib.so")
+    chess_lib = ctypes.CDLL("../backend/shared_lib/shared_lib.so")
+    chess_lib.zobrist_init()
+    attack_table = wrappers.attack_table_create_w(chess_lib)
+
+    fens = [
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    ]
+
+    total_errors = 0
+    for fen in fens:
+        board = wrappers.board_from_fen_w(chess_lib, fen)
+        errors, positions = walk(chess_lib, board, attack_table, 2)
+        print(fen, "\t", positions, "positions,", errors, "missmatches")
+        total_errors += errors
+
+    print("OK" if total_errors == 0 else "FAILED")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,54 @@
+import ctypes
+from c_lib import wrappers
+
+DEEP = 20
+SHALLOW = 2
+
+
+def cluster_keys(t_table, count, cluster=5):
+    """Keys that all map to the same cluster."""
+    cluster_count = t_table.contents.cluster_count
+    return [(i + 1) * cluster_count + cluster for i in range(count)]
+
+
+def fill_and_store(chess_lib, searches_between):
+    """Fills a cluster with deep entries, then stores a shallow entry after the given number of new searches."""
+    t_table = wrappers.tt_create(chess_lib, 1)
+    keys = cluster_keys(t_table, wrappers.TT_CLUSTER_SIZE + 1)
+
+    for key in keys[:-1]:
+        wrappers.tt_store(chess_lib, t_table, key, DEEP, 0, wrappers.TTEntryType.TT_EXACT, 0)
+    for _ in range(searches_between):
+        wrappers.tt_new_search(chess_lib, t_table)
+    wrappers.tt_store(chess_lib, t_table, keys[-1], SHALLOW, 0, wrappers.TTEntryType.TT_EXACT, 0)
+
+    stored = wrappers.tt_lookup(chess_lib, t_table, keys[-1]) is not None
+    remaining = sum(wrappers.tt_lookup(chess_lib, t_table, key) is not None for key in keys[:-1])
+    wrappers.tt_destroy(chess_lib, t_table)
+
+    return stored, remaining
+
+
+def main():
+    ctypes.cdll.LoadLibrary("../backend/shared_lib/shared_lib.so")
+    chess_lib = ctypes.CDLL("../backend/shared_lib/shared_lib.so")
+
+    errors = 0
+
+    # Deep entries from the current search are kept.
+    stored, remaining = fill_and_store(chess_lib, 0)
+    if stored or remaining != wrappers.TT_CLUSTER_SIZE:
+        print("Shallow entry replaced a deep entry of the current search")
+        errors += 1
+
+    # Stale deep entries give way, one at a time.
+    stored, remaining = fill_and_store(chess_lib, 1)
+    if not stored or remaining != wrappers.TT_CLUSTER_SIZE - 1:
+        print("Shallow entry didn't replace a deep entry of an earlier search")
+        errors += 1
+
+    print("OK" if errors == 0 else "FAILED")
+
+
+if __name__ == "__main__":
+    main()